@@ -0,0 +1,97 @@
+/**
+ * @file    ArchiveAwait.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   C++20 co_await adapter for the asynchronous BookArchive API
+ *
+ * @details Declares onArchive(), which lets a coroutine await any call on a
+ *          BookArchive without blocking its thread:
+ *
+ *              BookResults books = co_await onArchive(archive, [&](BookArchive& a) {
+ *                  return a.searchBook(keyword);
+ *              });
+ *
+ *          The call runs on a query worker (BookArchive::post) and the
+ *          coroutine resumes on that worker with the result, or with the
+ *          exception the call threw. An event loop that must finish on its
+ *          own thread posts the continuation back to itself. Writes may be
+ *          awaited the same way through addBookAsync() and the rest, at the
+ *          cost of holding a worker until the writer commits.
+ *
+ *          Only available when building as C++20 (make CXX_STD=c++20);
+ *          under C++17 this header declares nothing.
+ *
+ */
+
+#ifndef ARCHIVE_AWAIT_H
+#define ARCHIVE_AWAIT_H
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "BookArchive.h"
+
+template <typename Fn>
+class ArchiveAwaitable {
+public:
+    using Result = std::invoke_result_t<Fn&, BookArchive&>;
+
+    ArchiveAwaitable(BookArchive& archive, Fn fn) : archive(archive), fn(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    // False resumes the coroutine at once: the archive refused the task
+    bool await_suspend(std::coroutine_handle<> handle) {
+        bool queued = archive.post([this, handle](BookArchive& target) {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    fn(target);
+                    result.emplace();
+                } else {
+                    result.emplace(fn(target));
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            handle.resume();
+        });
+        if (!queued) {
+            error = std::make_exception_ptr(std::runtime_error("BookArchive is shutting down"));
+        }
+        return queued;
+    }
+
+    Result await_resume() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result);
+        }
+    }
+
+private:
+    struct Empty {};
+
+    BookArchive& archive;
+    Fn fn;
+    std::optional<std::conditional_t<std::is_void_v<Result>, Empty, Result>> result;
+    std::exception_ptr error;
+};
+
+// Awaitable running fn(archive) on a query worker
+template <typename Fn>
+ArchiveAwaitable<Fn> onArchive(BookArchive& archive, Fn fn) {
+    return ArchiveAwaitable<Fn>(archive, std::move(fn));
+}
+
+#endif // __cpp_impl_coroutine
+
+#endif // ARCHIVE_AWAIT_H
@@ -0,0 +1,210 @@
+/**
+ * @file    ArchiveMaintenance.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the background checkpoint and ANALYZE thread
+ */
+
+#include "ArchiveMaintenance.h"
+#include <chrono>
+
+namespace {
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+ArchiveMaintenance::ArchiveMaintenance()
+    : conn(nullptr), stopping(false), checkpoint_pages(0), checkpoint_wanted(false), last_commit_ns(0), commits(0),
+      passive_checkpoints(0), restart_checkpoints(0), truncate_checkpoints(0), incomplete_checkpoints(0), pages_checkpointed(0),
+      checkpoint_ns(0), analyze_runs(0), analyze_ns(0), wal_pages(0), max_wal_pages(0) {}
+
+ArchiveMaintenance::~ArchiveMaintenance() {
+    stop();
+}
+
+bool ArchiveMaintenance::start(const std::string& db_file, int pages, Reporter reporter, std::string& error) {
+    // A connection of its own, so checkpoints never wait for db_mutex
+    if (sqlite3_open_v2(db_file.c_str(), &conn, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        error = "Cannot open maintenance connection: " + std::string(sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        conn = nullptr;
+        return false;
+    }
+
+    // Read once, so the connection opens the WAL; until then checkpoints find no log
+    if (sqlite3_exec(conn, "SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        error = "Cannot read through the maintenance connection: " + std::string(sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        conn = nullptr;
+        return false;
+    }
+
+    // Bounds how long RESTART and TRUNCATE wait; PASSIVE never waits
+    sqlite3_busy_timeout(conn, MAINTENANCE_RESTART_WAIT_MS);
+
+    report = std::move(reporter);
+    checkpoint_pages = pages;
+    last_commit_ns = steadyNowNs();
+    stopping = false;
+    thread = std::thread(&ArchiveMaintenance::run, this);
+    return true;
+}
+
+void ArchiveMaintenance::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (conn) {
+        sqlite3_close(conn);
+        conn = nullptr;
+    }
+}
+
+int ArchiveMaintenance::walHook(void* maintenance, sqlite3*, const char*, int pages) {
+    auto* self = static_cast<ArchiveMaintenance*>(maintenance);
+    uint64_t size = static_cast<uint64_t>(pages);
+
+    self->wal_pages.store(size, std::memory_order_relaxed);
+    uint64_t peak = self->max_wal_pages.load(std::memory_order_relaxed);
+    while (size > peak && !self->max_wal_pages.compare_exchange_weak(peak, size, std::memory_order_relaxed)) {
+    }
+    self->last_commit_ns.store(steadyNowNs(), std::memory_order_relaxed);
+    self->commits.fetch_add(1, std::memory_order_relaxed);
+
+    // Notified without the mutex, so the committing writer never blocks on it.
+    // A wakeup that races the thread going to sleep waits for the next tick.
+    int threshold = self->checkpoint_pages.load(std::memory_order_relaxed);
+    if (threshold > 0 && pages >= threshold && !self->checkpoint_wanted.exchange(true)) {
+        self->wake.notify_one();
+    }
+    return SQLITE_OK;
+}
+
+void ArchiveMaintenance::setCheckpointPages(int pages) {
+    checkpoint_pages = pages;
+}
+
+ArchiveMaintenance::Counters ArchiveMaintenance::counters() const {
+    Counters out;
+    out.passive_checkpoints = passive_checkpoints.load(std::memory_order_relaxed);
+    out.restart_checkpoints = restart_checkpoints.load(std::memory_order_relaxed);
+    out.truncate_checkpoints = truncate_checkpoints.load(std::memory_order_relaxed);
+    out.incomplete_checkpoints = incomplete_checkpoints.load(std::memory_order_relaxed);
+    out.pages_checkpointed = pages_checkpointed.load(std::memory_order_relaxed);
+    out.checkpoint_ns = checkpoint_ns.load(std::memory_order_relaxed);
+    out.analyze_runs = analyze_runs.load(std::memory_order_relaxed);
+    out.analyze_ns = analyze_ns.load(std::memory_order_relaxed);
+    out.wal_pages = wal_pages.load(std::memory_order_relaxed);
+    out.max_wal_pages = max_wal_pages.load(std::memory_order_relaxed);
+    out.running = thread.joinable();
+    return out;
+}
+
+void ArchiveMaintenance::run() {
+    const int64_t idle_ns = static_cast<int64_t>(MAINTENANCE_IDLE_MS) * 1000000;
+    const auto analyze_interval = std::chrono::seconds(MAINTENANCE_ANALYZE_INTERVAL_S);
+
+    // Commit counts at the last idle checkpoint and ANALYZE: each runs once per
+    // idle period, and not at all without writes in between
+    uint64_t truncated_at = commits.load();
+    uint64_t analyzed_at = truncated_at;
+    auto last_analyze = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(MAINTENANCE_TICK_MS),
+                      [this] { return stopping || checkpoint_wanted.load(); });
+        if (stopping) {
+            break;
+        }
+        lock.unlock();
+
+        int threshold = checkpoint_pages.load();
+        uint64_t seen = commits.load();
+        bool idle = steadyNowNs() - last_commit_ns.load() >= idle_ns;
+
+        if (checkpoint_wanted.exchange(false) && threshold > 0) {
+            bool runaway = wal_pages.load() >= static_cast<uint64_t>(threshold) * MAINTENANCE_RESTART_FACTOR;
+            checkpoint(runaway ? SQLITE_CHECKPOINT_RESTART : SQLITE_CHECKPOINT_PASSIVE);
+        } else if (idle && threshold > 0 && seen != truncated_at && wal_pages.load() > 0) {
+            truncated_at = seen;
+            checkpoint(SQLITE_CHECKPOINT_TRUNCATE);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (idle && seen != analyzed_at && now - last_analyze >= analyze_interval) {
+            last_analyze = now;
+            analyzed_at = seen;
+            analyze();
+        }
+
+        lock.lock();
+    }
+}
+
+void ArchiveMaintenance::checkpoint(int mode) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t before = wal_pages.load();
+    int log_pages = 0;
+    int done_pages = 0;
+
+    // A RESTART or TRUNCATE that still finds readers or the writer active after
+    // the busy timeout does the passive part and reports SQLITE_BUSY
+    int rc = sqlite3_wal_checkpoint_v2(conn, nullptr, mode, &log_pages, &done_pages);
+
+    checkpoint_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+    switch (mode) {
+        case SQLITE_CHECKPOINT_PASSIVE: passive_checkpoints.fetch_add(1); break;
+        case SQLITE_CHECKPOINT_RESTART: restart_checkpoints.fetch_add(1); break;
+        default: truncate_checkpoints.fetch_add(1);
+    }
+
+    if (rc == SQLITE_OK && mode == SQLITE_CHECKPOINT_TRUNCATE) {
+        // The log is empty now and reports no frames; count what it held
+        pages_checkpointed.fetch_add(before);
+        wal_pages = 0;
+        return;
+    }
+
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        report(LogLevel::ERROR, "WAL checkpoint failed: " + std::string(sqlite3_errmsg(conn)));
+        return;
+    }
+    if (rc == SQLITE_BUSY || done_pages < log_pages) {
+        incomplete_checkpoints.fetch_add(1);
+    }
+    if (done_pages > 0) {
+        pages_checkpointed.fetch_add(static_cast<uint64_t>(done_pages));
+    }
+}
+
+void ArchiveMaintenance::analyze() {
+    auto start = std::chrono::steady_clock::now();
+
+    // Sampled, so even a large archive is analyzed in milliseconds
+    std::string sql = "PRAGMA analysis_limit = " + std::to_string(MAINTENANCE_ANALYZE_LIMIT) + "; ANALYZE;";
+    char* errmsg = nullptr;
+    if (sqlite3_exec(conn, sql.c_str(), nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        // Usually the writer holding the lock; the next interval tries again
+        report(LogLevel::INFO, "ANALYZE skipped: " + std::string(errmsg ? errmsg : "unknown error"));
+        sqlite3_free(errmsg);
+        return;
+    }
+
+    analyze_runs.fetch_add(1);
+    analyze_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+    report(LogLevel::INFO, "Planner statistics refreshed with ANALYZE");
+}
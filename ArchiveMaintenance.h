@@ -0,0 +1,115 @@
+/**
+ * @file    ArchiveMaintenance.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Background WAL checkpoints and statistics upkeep
+ *
+ * @details Declares ArchiveMaintenance, the thread BookArchive runs next to
+ *          its writer. The writer's WAL hook reports the size of the WAL
+ *          after every commit, which replaces SQLite's own autocheckpoint:
+ *          instead of the committing writer stalling on a checkpoint, this
+ *          thread runs a PASSIVE checkpoint on its own connection once the
+ *          WAL passes the configured size, and a TRUNCATE checkpoint when
+ *          the archive has been idle for a while, so the file shrinks back.
+ *          Readers that keep every passive checkpoint from finishing would
+ *          let the WAL grow without bound; at MAINTENANCE_RESTART_FACTOR
+ *          times the threshold a RESTART checkpoint briefly holds off new
+ *          writers until the WAL can start over.
+ *          It also refreshes the planner statistics (ANALYZE, sampled) at
+ *          most once per interval, and only after writes.
+ *
+ */
+
+#ifndef ARCHIVE_MAINTENANCE_H
+#define ARCHIVE_MAINTENANCE_H
+
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "AsyncLogger.h"
+
+#define MAINTENANCE_TICK_MS 500               // How often the thread looks at the WAL when not woken
+#define MAINTENANCE_IDLE_MS 2000              // No commits for this long counts as idle
+#define MAINTENANCE_RESTART_FACTOR 4           // WAL this many times the threshold forces a RESTART checkpoint
+#define MAINTENANCE_RESTART_WAIT_MS 50        // Longest a RESTART checkpoint waits for readers and the writer
+#define MAINTENANCE_ANALYZE_INTERVAL_S 3600   // Shortest time between two ANALYZE runs
+#define MAINTENANCE_ANALYZE_LIMIT 1000        // PRAGMA analysis_limit: rows sampled per index
+
+class ArchiveMaintenance {
+public:
+    // What the thread has done so far
+    struct Counters {
+        uint64_t passive_checkpoints = 0;   // Started because the WAL was large
+        uint64_t restart_checkpoints = 0;   // Started because readers kept it from shrinking
+        uint64_t truncate_checkpoints = 0;  // Started because the archive was idle
+        uint64_t incomplete_checkpoints = 0;  // Stopped short by readers or the writer
+        uint64_t pages_checkpointed = 0;
+        uint64_t checkpoint_ns = 0;
+        uint64_t analyze_runs = 0;
+        uint64_t analyze_ns = 0;
+        uint64_t wal_pages = 0;             // WAL size after the last commit or checkpoint
+        uint64_t max_wal_pages = 0;
+        bool running = false;
+    };
+
+    using Reporter = std::function<void(LogLevel level, const std::string& message)>;
+
+    ArchiveMaintenance();
+    ~ArchiveMaintenance();  // Stops the thread
+
+    ArchiveMaintenance(const ArchiveMaintenance&) = delete;
+    ArchiveMaintenance& operator=(const ArchiveMaintenance&) = delete;
+
+    // Open a connection to db_file and start the thread. checkpoint_pages is
+    // the WAL size that triggers a checkpoint, 0 = never checkpoint.
+    bool start(const std::string& db_file, int checkpoint_pages, Reporter report, std::string& error);
+
+    // Finish the current job, stop the thread and close its connection
+    void stop();
+
+    // Install as the writer's WAL hook (sqlite3_wal_hook) with this as the argument
+    static int walHook(void* maintenance, sqlite3* db, const char* schema, int wal_pages);
+
+    // Change the checkpoint threshold, e.g. for the duration of a bulk load
+    void setCheckpointPages(int pages);
+
+    Counters counters() const;
+
+private:
+    void run();
+    void checkpoint(int mode);
+    void analyze();
+
+    sqlite3* conn;
+    Reporter report;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    // Written by the WAL hook on the writer's thread
+    std::atomic<int> checkpoint_pages;
+    std::atomic<bool> checkpoint_wanted;
+    std::atomic<int64_t> last_commit_ns;
+    std::atomic<uint64_t> commits;
+
+    std::atomic<uint64_t> passive_checkpoints;
+    std::atomic<uint64_t> restart_checkpoints;
+    std::atomic<uint64_t> truncate_checkpoints;
+    std::atomic<uint64_t> incomplete_checkpoints;
+    std::atomic<uint64_t> pages_checkpointed;
+    std::atomic<uint64_t> checkpoint_ns;
+    std::atomic<uint64_t> analyze_runs;
+    std::atomic<uint64_t> analyze_ns;
+    std::atomic<uint64_t> wal_pages;
+    std::atomic<uint64_t> max_wal_pages;
+};
+
+#endif // ARCHIVE_MAINTENANCE_H
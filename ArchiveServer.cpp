@@ -0,0 +1,454 @@
+/**
+ * @file    ArchiveServer.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the epoll-based BookArchive server
+ */
+
+#include "ArchiveServer.h"
+#include "BookArchive.h"
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+// epoll tokens below the first connection id
+static const uint64_t LISTEN_TOKEN = 0;
+static const uint64_t WAKE_TOKEN = 1;
+
+// Read or write files on the server, or change settings of the whole process.
+// With an option, only the form of the command taking that option is refused.
+struct AdminCommand {
+    const char* action;
+    const char* option;
+};
+
+static const AdminCommand ADMIN_COMMANDS[] = {
+    {"import", nullptr},
+    {"export", nullptr},
+    {"export-snapshot", nullptr},
+    {"load-snapshot", nullptr},
+    {"debug", nullptr},
+    {"delete-many", "--file"},
+    {"search-many", "--file"},
+};
+
+// The refused form of command ("import", "delete-many --file"), empty if it may be served
+static std::string adminForm(std::string_view command) {
+    CommandTokenizer args(command);
+    std::string_view action = args.next();
+    for (const AdminCommand& admin : ADMIN_COMMANDS) {
+        if (action != admin.action) {
+            continue;
+        }
+        if (!admin.option) {
+            return std::string(action);
+        }
+        // Options may follow others (search-many --format json --file ...), so look at every token
+        for (std::string_view token = args.next(); !token.empty(); token = args.next()) {
+            if (token == admin.option) {
+                return std::string(action) + " " + admin.option;
+            }
+        }
+    }
+    return {};
+}
+
+ArchiveServer::ArchiveServer(BookArchive& archive, size_t worker_count, bool allow_admin)
+    : archive(archive), worker_count(worker_count > 0 ? worker_count : 1), allow_admin(allow_admin),
+      listen_fd(-1), epoll_fd(-1), wake_fd(-1), stopping(false), next_conn_id(2), draining(false),
+      workers_stopping(false) {
+}
+
+#ifdef __linux__
+
+ArchiveServer::~ArchiveServer() {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        workers_stopping = true;
+    }
+    jobs_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto& entry : connections) {
+        ::close(entry.second.fd);
+    }
+    if (listen_fd >= 0) ::close(listen_fd);
+    if (epoll_fd >= 0) ::close(epoll_fd);
+    if (wake_fd >= 0) ::close(wake_fd);
+}
+
+bool ArchiveServer::start(const std::string& host, uint16_t port, std::string& error) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        error = "Invalid listen address '" + host + "'";
+        return false;
+    }
+
+    listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int on = 1;
+    if (listen_fd < 0 || ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+        ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd, SERVER_LISTEN_BACKLOG) < 0) {
+        error = "Cannot listen on " + host + ":" + std::to_string(port) + ": " + std::strerror(errno);
+        return false;
+    }
+
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        error = std::string("Cannot create event loop: ") + std::strerror(errno);
+        return false;
+    }
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = LISTEN_TOKEN;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.u64 = WAKE_TOKEN;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&ArchiveServer::workerLoop, this);
+    }
+    return true;
+}
+
+void ArchiveServer::stop() {
+    stopping.store(true);
+    if (wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void ArchiveServer::run() {
+    epoll_event events[SERVER_EVENT_BATCH];
+    std::chrono::steady_clock::time_point deadline;
+
+    for (;;) {
+        int timeout = -1;
+        if (stopping.load() && !draining) {
+            beginShutdown();
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SERVER_SHUTDOWN_GRACE_MS);
+        }
+        if (draining) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (connections.empty() || left.count() <= 0) {
+                break;
+            }
+            timeout = static_cast<int>(left.count());
+        }
+
+        int ready = ::epoll_wait(epoll_fd, events, SERVER_EVENT_BATCH, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            uint64_t token = events[i].data.u64;
+            if (token == LISTEN_TOKEN) {
+                acceptClients();
+                continue;
+            }
+            if (token == WAKE_TOKEN) {
+                uint64_t count;
+                while (::read(wake_fd, &count, sizeof(count)) > 0) {
+                }
+                collectResults();
+                continue;
+            }
+
+            // The connection may have been closed by an earlier event in this batch
+            auto it = connections.find(token);
+            if (it == connections.end()) {
+                continue;
+            }
+            uint32_t flags = events[i].events;
+            if (flags & EPOLLERR) {
+                closeClient(token);
+                continue;
+            }
+
+            // A hang-up can arrive with the client's last requests: read them
+            // first, and answer what is owed before closing
+            if ((flags & (EPOLLIN | EPOLLHUP)) && !draining) {
+                readClient(token, it->second);
+            }
+            it = connections.find(token);
+            if (it != connections.end() && (flags & EPOLLOUT)) {
+                writeClient(token, it->second);
+            }
+            it = connections.find(token);
+            if (it != connections.end() && (flags & EPOLLHUP)) {
+                hangUp(token, it->second);
+            }
+        }
+    }
+}
+
+void ArchiveServer::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            // Only the destructor ends the workers: run() still hands out pipelined commands while it drains
+            jobs_ready.wait(lock, [this] { return workers_stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;  // Stopping and drained
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        std::string refused = allow_admin ? std::string() : adminForm(job.command);
+        if (!refused.empty()) {
+            job.command = "Error: '" + refused + "' is not served over the network "
+                          "(start the server with --serve-admin to allow it).\n";
+        } else {
+            std::ostringstream out;
+            archive.executeCommand(job.command, out);
+            job.command = out.str();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results.push_back(std::move(job));
+        }
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void ArchiveServer::acceptClients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;  // EAGAIN: no more pending connections (or a transient error)
+        }
+
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        uint64_t id = next_conn_id++;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = id;
+        if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections[id].fd = fd;
+    }
+}
+
+void ArchiveServer::readClient(uint64_t id, Connection& conn) {
+    char buffer[16384];
+    for (;;) {
+        ssize_t n = ::read(conn.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            conn.input.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            // Peer finished sending: answer what it already asked, then close
+            conn.closing = true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        break;
+    }
+
+    size_t start = 0;
+    size_t end;
+    while ((end = conn.input.find('\n', start)) != std::string::npos) {
+        std::string line = conn.input.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        std::string_view action = CommandTokenizer(line).next();
+        if (action.empty()) {
+            continue;
+        }
+        if (action == "exit" || action == "quit") {
+            // Nothing after this is read; queued commands are still answered
+            conn.closing = true;
+            start = conn.input.size();
+            break;
+        }
+        conn.pending.push_back(std::move(line));
+    }
+    conn.input.erase(0, start);
+
+    if (conn.input.size() > SERVER_MAX_LINE) {
+        closeClient(id);
+        return;
+    }
+
+    dispatchNext(id, conn);
+    writeClient(id, conn);  // Closes the connection if it is finished
+}
+
+void ArchiveServer::dispatchNext(uint64_t id, Connection& conn) {
+    // One command per connection at a time keeps responses in request order
+    if (conn.busy || conn.pending.empty()) {
+        return;
+    }
+    conn.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.push_back(Job{id, std::move(conn.pending.front())});
+    }
+    conn.pending.pop_front();
+    jobs_ready.notify_one();
+}
+
+void ArchiveServer::collectResults() {
+    std::vector<Job> done;
+    {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        done.swap(results);
+    }
+
+    for (Job& result : done) {
+        auto it = connections.find(result.conn_id);
+        if (it == connections.end()) {
+            continue;  // Client went away while its command ran
+        }
+        Connection& conn = it->second;
+        conn.busy = false;
+        conn.output += std::to_string(result.command.size());
+        conn.output += '\n';
+        conn.output += result.command;
+
+        dispatchNext(result.conn_id, conn);
+        writeClient(result.conn_id, conn);
+    }
+}
+
+void ArchiveServer::writeClient(uint64_t id, Connection& conn) {
+    size_t written = 0;
+    while (written < conn.output.size()) {
+        ssize_t n = ::send(conn.fd, conn.output.data() + written, conn.output.size() - written, MSG_NOSIGNAL);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !conn.hung_up) {
+            break;
+        }
+        closeClient(id);
+        return;
+    }
+    conn.output.erase(0, written);
+
+    if (conn.closing && conn.output.empty() && !conn.busy && conn.pending.empty()) {
+        closeClient(id);
+        return;
+    }
+    updateEvents(id, conn);
+}
+
+void ArchiveServer::updateEvents(uint64_t id, Connection& conn) {
+    if (conn.hung_up) {
+        return;
+    }
+
+    // Back-pressure: stop reading from clients that do not keep up with their answers
+    bool want_read = !conn.closing &&
+        conn.output.size() < SERVER_MAX_PENDING_OUTPUT && conn.pending.size() < SERVER_MAX_PIPELINE;
+    bool want_write = !conn.output.empty();
+
+    if (want_read == conn.reading && want_write == conn.writing) {
+        return;
+    }
+    conn.reading = want_read;
+    conn.writing = want_write;
+
+    epoll_event ev;
+    ev.events = (want_read ? EPOLLIN : 0u) | (want_write ? EPOLLOUT : 0u);
+    ev.data.u64 = id;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void ArchiveServer::closeClient(uint64_t id) {
+    auto it = connections.find(id);
+    if (it == connections.end()) {
+        return;
+    }
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    connections.erase(it);
+}
+
+void ArchiveServer::hangUp(uint64_t id, Connection& conn) {
+    // epoll would report the hang-up on every wait while the last commands run
+    conn.closing = true;
+    conn.hung_up = true;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn.fd, nullptr);
+    writeClient(id, conn);  // Closes the connection if nothing is owed
+}
+
+void ArchiveServer::beginShutdown() {
+    draining = true;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, nullptr);
+
+    // Nothing more is read; each client is closed once its accepted commands are answered
+    std::vector<uint64_t> ids;
+    ids.reserve(connections.size());
+    for (const auto& entry : connections) {
+        ids.push_back(entry.first);
+    }
+    for (uint64_t id : ids) {
+        Connection& conn = connections[id];
+        conn.closing = true;
+        writeClient(id, conn);
+    }
+}
+
+#else
+
+ArchiveServer::~ArchiveServer() = default;
+
+bool ArchiveServer::start(const std::string&, uint16_t, std::string& error) {
+    error = "Server mode requires Linux (epoll)";
+    return false;
+}
+
+void ArchiveServer::run() {
+}
+
+void ArchiveServer::stop() {
+    stopping.store(true);
+}
+
+#endif // __linux__
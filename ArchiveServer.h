@@ -0,0 +1,128 @@
+/**
+ * @file    ArchiveServer.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   TCP server exposing the BookArchive command set
+ *
+ * @details Declares ArchiveServer, which lets many clients share one warm
+ *          BookArchive (its read connections and caches) over TCP. A single
+ *          epoll event loop accepts connections and splits their input into
+ *          commands, and a pool of worker threads runs them through
+ *          BookArchive::executeCommand.
+ *
+ *          Protocol: every request is one command line, exactly as typed at
+ *          the interactive prompt, terminated by '\n'. Every response is the
+ *          byte length of the command's output in decimal, a '\n', then that
+ *          many bytes of output. Requests on one connection may be pipelined
+ *          and are answered in order. "exit" or "quit" closes the connection.
+ *
+ *          Commands that touch files on the server or settings of the whole
+ *          process (import, export, export-snapshot, load-snapshot, debug,
+ *          delete-many --file, search-many --file) are refused unless the server was created with allow_admin, as
+ *          they would let any peer read or overwrite files with the
+ *          server's permissions.
+ *
+ *          Only Linux is supported (epoll); elsewhere start() fails.
+ *
+ */
+
+#ifndef ARCHIVE_SERVER_H
+#define ARCHIVE_SERVER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+#define SERVER_DEFAULT_HOST "127.0.0.1"
+#define SERVER_MAX_LINE 65536             // Longest accepted request line
+#define SERVER_MAX_PENDING_OUTPUT 4194304 // Stop reading from a client this far behind
+#define SERVER_MAX_PIPELINE 256           // ...or with this many commands queued
+#define SERVER_LISTEN_BACKLOG 1024
+#define SERVER_EVENT_BATCH 256
+#define SERVER_SHUTDOWN_GRACE_MS 5000      // Longest stop() waits for accepted commands to be answered
+
+class BookArchive;
+
+class ArchiveServer {
+public:
+    ArchiveServer(BookArchive& archive, size_t worker_count, bool allow_admin = false);
+    ~ArchiveServer();
+
+    ArchiveServer(const ArchiveServer&) = delete;
+    ArchiveServer& operator=(const ArchiveServer&) = delete;
+
+    // Listen on host:port and start the workers
+    bool start(const std::string& host, uint16_t port, std::string& error);
+
+    // Serve clients until stop() is called. Commands accepted by then still
+    // run and are answered, for up to SERVER_SHUTDOWN_GRACE_MS.
+    void run();
+
+    // Ask run() to finish up and return; safe to call from a signal handler or another thread
+    void stop();
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string input;                  // Bytes received, not yet a full line
+        std::string output;                 // Responses not yet written
+        std::deque<std::string> pending;    // Complete commands waiting their turn
+        bool busy = false;                  // A worker is running one of its commands
+        bool closing = false;               // Close once output is written
+        bool reading = true;                // Registered for EPOLLIN
+        bool writing = false;               // Registered for EPOLLOUT
+        bool hung_up = false;               // EPOLLHUP: removed from epoll, answers are sent as they come
+    };
+
+    // A command handed to a worker, or a worker's answer to one
+    struct Job {
+        uint64_t conn_id;
+        std::string command;
+    };
+
+    void workerLoop();
+    void acceptClients();
+    void readClient(uint64_t id, Connection& conn);
+    void writeClient(uint64_t id, Connection& conn);
+    void dispatchNext(uint64_t id, Connection& conn);
+    void collectResults();
+    void updateEvents(uint64_t id, Connection& conn);
+    void closeClient(uint64_t id);
+    void hangUp(uint64_t id, Connection& conn);
+    void beginShutdown();
+
+    BookArchive& archive;
+    size_t worker_count;
+    bool allow_admin;  // Serve the file and process-wide commands too
+    std::vector<std::thread> workers;
+
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;  // eventfd: workers finished jobs, or stop() was called
+    std::atomic<bool> stopping;
+
+    // Owned by the event loop thread
+    std::unordered_map<uint64_t, Connection> connections;
+    uint64_t next_conn_id;
+    bool draining;  // Stopping: answering what was accepted, reading nothing more
+
+    // Loop -> workers
+    std::deque<Job> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_ready;
+    bool workers_stopping;  // Set by the destructor: exit once jobs is empty
+
+    // Workers -> loop
+    std::vector<Job> results;
+    std::mutex results_mutex;
+};
+
+#endif // ARCHIVE_SERVER_H
@@ -0,0 +1,132 @@
+/**
+ * @file    ArchiveStats.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the BookArchive latency histograms
+ */
+
+#include "ArchiveStats.h"
+
+#ifdef ENABLE_STATS
+
+ArchiveStats::Histogram::Histogram() : count(0), total(0), max(0) {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+unsigned ArchiveStats::Histogram::bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<unsigned>(value);
+    }
+
+    // Top SUB_BUCKET_BITS + 1 significant bits select the bucket
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    if (msb >= STATS_MAX_VALUE_BITS) {
+        return BUCKETS - 1;
+    }
+    unsigned shift = msb - STATS_SUB_BUCKET_BITS;
+    unsigned sub = static_cast<unsigned>(value >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t ArchiveStats::Histogram::bucketUpperBound(unsigned bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void ArchiveStats::Histogram::record(uint64_t value) {
+    buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (value > seen && !max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary ArchiveStats::Histogram::summarize() const {
+    LatencySummary summary;
+    summary.total_ns = total.load(std::memory_order_relaxed);
+    summary.max_ns = max.load(std::memory_order_relaxed);
+
+    // Copy the buckets first so the percentiles agree with one count
+    uint64_t counts[BUCKETS];
+    for (unsigned i = 0; i < BUCKETS; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        summary.count += counts[i];
+    }
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    const double quantiles[] = {0.50, 0.99, 0.999};
+    uint64_t* targets[] = {&summary.p50_ns, &summary.p99_ns, &summary.p999_ns};
+    uint64_t seen = 0;
+    unsigned next = 0;
+    for (unsigned i = 0; i < BUCKETS && next < 3; ++i) {
+        seen += counts[i];
+        while (next < 3 && seen >= static_cast<uint64_t>(quantiles[next] * summary.count + 0.5)) {
+            // Never report more than the largest value actually recorded
+            uint64_t bound = bucketUpperBound(i);
+            *targets[next++] = bound < summary.max_ns ? bound : summary.max_ns;
+        }
+    }
+    return summary;
+}
+
+void ArchiveStats::Histogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+ArchiveStats::ArchiveStats() : executes(0), queries(0), rows(0), write_groups(0), grouped_writes(0), busy_waits(0), busy_wait_ns(0),
+      busy_timeouts(0), lock_retries(0), lock_wait_ns(0) {
+}
+
+void ArchiveStats::snapshot(StatsSnapshot& out) const {
+    out.enabled = true;
+    out.executes = executes.load(std::memory_order_relaxed);
+    out.queries = queries.load(std::memory_order_relaxed);
+    out.rows = rows.load(std::memory_order_relaxed);
+    out.write_groups = write_groups.load(std::memory_order_relaxed);
+    out.grouped_writes = grouped_writes.load(std::memory_order_relaxed);
+    out.busy_waits = busy_waits.load(std::memory_order_relaxed);
+    out.busy_wait_ns = busy_wait_ns.load(std::memory_order_relaxed);
+    out.busy_timeouts = busy_timeouts.load(std::memory_order_relaxed);
+    out.lock_retries = lock_retries.load(std::memory_order_relaxed);
+    out.lock_wait_ns = lock_wait_ns.load(std::memory_order_relaxed);
+
+    out.prepare = histograms[PREPARE].summarize();
+    out.bind = histograms[BIND].summarize();
+    out.step = histograms[STEP].summarize();
+    out.materialize = histograms[MATERIALIZE].summarize();
+}
+
+void ArchiveStats::reset() {
+    for (auto& histogram : histograms) {
+        histogram.reset();
+    }
+    executes.store(0, std::memory_order_relaxed);
+    queries.store(0, std::memory_order_relaxed);
+    rows.store(0, std::memory_order_relaxed);
+    write_groups.store(0, std::memory_order_relaxed);
+    grouped_writes.store(0, std::memory_order_relaxed);
+    busy_waits.store(0, std::memory_order_relaxed);
+    busy_wait_ns.store(0, std::memory_order_relaxed);
+    busy_timeouts.store(0, std::memory_order_relaxed);
+    lock_retries.store(0, std::memory_order_relaxed);
+    lock_wait_ns.store(0, std::memory_order_relaxed);
+}
+
+#endif // ENABLE_STATS
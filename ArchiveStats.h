@@ -0,0 +1,189 @@
+/**
+ * @file    ArchiveStats.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Hot-path counters and latency histograms for BookArchive
+ *
+ * @details Declares ArchiveStats, which times the phases of every statement
+ *          BookArchive runs (prepare, bind, step and row materialization)
+ *          into HDR-style log-linear histograms, and counts how often and
+ *          how long callers waited on a locked database. Recording is a few
+ *          relaxed atomic increments. Without ENABLE_STATS the class and its
+ *          timers are empty inline stubs, so instrumented code compiles to
+ *          nothing.
+ *
+ */
+
+#ifndef ARCHIVE_STATS_H
+#define ARCHIVE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "StatementCache.h"
+#include "BookCache.h"
+#include "ArchiveMaintenance.h"
+#include "SuggestIndex.h"
+#include "QueryExecutor.h"
+#include "SearchCache.h"
+
+// Histogram resolution: every power of two is split into this many buckets (~6% error)
+#define STATS_SUB_BUCKET_BITS 4
+#define STATS_MAX_VALUE_BITS 40  // Values up to 2^40 ns (~18 minutes)
+
+// Latency summary of one histogram, in nanoseconds
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+
+    uint64_t meanNs() const { return count > 0 ? total_ns / count : 0; }
+};
+
+// Point-in-time copy of everything BookArchive counts
+struct StatsSnapshot {
+    bool enabled = false;  // False when built without ENABLE_STATS
+
+    uint64_t executes = 0;        // Write statements run
+    uint64_t queries = 0;         // Cursors opened
+    uint64_t rows = 0;            // Rows stepped through cursors
+    uint64_t write_groups = 0;    // Transactions committed by the writer thread
+    uint64_t grouped_writes = 0;  // Writes they contained
+    uint64_t busy_waits = 0;      // Sleeps in the busy handler, all connections
+    uint64_t busy_wait_ns = 0;    // Time they slept
+    uint64_t busy_timeouts = 0;   // Times the handler gave up and SQLITE_BUSY reached the caller
+    uint64_t lock_retries = 0;    // BEGIN IMMEDIATE retried after backing off outside db_mutex
+    uint64_t lock_wait_ns = 0;    // Time those backoffs slept
+
+    LatencySummary prepare;
+    LatencySummary bind;
+    LatencySummary step;
+    LatencySummary materialize;
+
+    StatementCache::Counters writer_statements;
+    StatementCache::Counters reader_statements;
+    BookCache::Counters books;
+    SearchCache::Counters searches;
+    ArchiveMaintenance::Counters maintenance;
+    SuggestIndex::Counters suggestions;
+    QueryExecutor::Counters async_reads;
+    uint64_t log_dropped = 0;
+};
+
+#ifdef ENABLE_STATS
+
+class ArchiveStats {
+public:
+    enum Phase { PREPARE, BIND, STEP, MATERIALIZE, PHASE_COUNT };
+
+    // Start time of one timed phase
+    class Timer {
+    public:
+        Timer() : start(std::chrono::steady_clock::now()) {}
+        uint64_t elapsedNs() const {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+
+    ArchiveStats();
+
+    ArchiveStats(const ArchiveStats&) = delete;
+    ArchiveStats& operator=(const ArchiveStats&) = delete;
+
+    void record(Phase phase, const Timer& timer) { histograms[phase].record(timer.elapsedNs()); }
+    void countExecute() { executes.fetch_add(1, std::memory_order_relaxed); }
+    void countQuery() { queries.fetch_add(1, std::memory_order_relaxed); }
+    void countRow() { rows.fetch_add(1, std::memory_order_relaxed); }
+    void countWriteGroup(size_t writes) {
+        write_groups.fetch_add(1, std::memory_order_relaxed);
+        grouped_writes.fetch_add(writes, std::memory_order_relaxed);
+    }
+    void countBusyWait(uint64_t slept_ns) {
+        busy_waits.fetch_add(1, std::memory_order_relaxed);
+        busy_wait_ns.fetch_add(slept_ns, std::memory_order_relaxed);
+    }
+    void countBusyTimeout() { busy_timeouts.fetch_add(1, std::memory_order_relaxed); }
+    void countLockRetry(uint64_t slept_ns) {
+        lock_retries.fetch_add(1, std::memory_order_relaxed);
+        lock_wait_ns.fetch_add(slept_ns, std::memory_order_relaxed);
+    }
+
+    // Fill the instrumentation fields of snapshot
+    void snapshot(StatsSnapshot& out) const;
+
+    void reset();
+
+private:
+    // Log-linear histogram: exact below 2^SUB_BUCKET_BITS, then a fixed
+    // number of linear buckets per power of two
+    class Histogram {
+    public:
+        static constexpr unsigned SUB_BUCKETS = 1u << STATS_SUB_BUCKET_BITS;
+        static constexpr unsigned BUCKETS = (STATS_MAX_VALUE_BITS - STATS_SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        Histogram();
+
+        void record(uint64_t value);
+        LatencySummary summarize() const;
+        void reset();
+
+    private:
+        static unsigned bucketFor(uint64_t value);
+        static uint64_t bucketUpperBound(unsigned bucket);
+
+        std::atomic<uint64_t> buckets[BUCKETS];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> max;
+    };
+
+    Histogram histograms[PHASE_COUNT];
+    std::atomic<uint64_t> executes;
+    std::atomic<uint64_t> queries;
+    std::atomic<uint64_t> rows;
+    std::atomic<uint64_t> write_groups;
+    std::atomic<uint64_t> grouped_writes;
+    std::atomic<uint64_t> busy_waits;
+    std::atomic<uint64_t> busy_wait_ns;
+    std::atomic<uint64_t> busy_timeouts;
+    std::atomic<uint64_t> lock_retries;
+    std::atomic<uint64_t> lock_wait_ns;
+};
+
+#else
+
+// Statistics disabled: every call is an empty inline function
+class ArchiveStats {
+public:
+    enum Phase { PREPARE, BIND, STEP, MATERIALIZE, PHASE_COUNT };
+
+    class Timer {
+    public:
+        uint64_t elapsedNs() const { return 0; }
+    };
+
+    void record(Phase, const Timer&) {}
+    void countExecute() {}
+    void countQuery() {}
+    void countRow() {}
+    void countWriteGroup(size_t) {}
+    void countBusyWait(uint64_t) {}
+    void countBusyTimeout() {}
+    void countLockRetry(uint64_t) {}
+    void snapshot(StatsSnapshot&) const {}
+    void reset() {}
+};
+
+#endif // ENABLE_STATS
+
+#endif // ARCHIVE_STATS_H
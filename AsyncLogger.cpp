@@ -0,0 +1,278 @@
+/**
+ * @file    AsyncLogger.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the asynchronous logger
+ *
+ * @details The ring buffer follows the classic bounded-queue design where
+ *          every slot carries a sequence number: producers claim a slot
+ *          with one compare-and-swap and publish it by bumping the
+ *          sequence, and the single writer thread consumes slots in order.
+ */
+
+#include "AsyncLogger.h"
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+std::string logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+static_assert((LOG_QUEUE_CAPACITY & (LOG_QUEUE_CAPACITY - 1)) == 0,
+              "LOG_QUEUE_CAPACITY must be a power of two");
+
+// Format "YYYY-mm-dd HH:MM:SS" in local time
+static void formatSecond(int64_t seconds, char* out, size_t size) {
+    std::time_t t = static_cast<std::time_t>(seconds);
+    std::tm local;
+    localtime_r(&t, &local);
+    std::strftime(out, size, "%Y-%m-%d %H:%M:%S", &local);
+}
+
+// Append "[stamp.mmm] [LEVEL] text\n" to the buffer
+static void formatRecord(std::string& buffer, const char* stamp, int millis, LogLevel level,
+                         const char* text, size_t length) {
+    char ms[4] = {
+        static_cast<char>('0' + millis / 100),
+        static_cast<char>('0' + millis / 10 % 10),
+        static_cast<char>('0' + millis % 10),
+        '\0'
+    };
+
+    buffer += '[';
+    buffer += stamp;
+    buffer += '.';
+    buffer += ms;
+    buffer += "] [";
+    buffer += logLevelToString(level);
+    buffer += "] ";
+    buffer.append(text, length);
+    buffer += '\n';
+}
+
+static int64_t nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+AsyncLogger::AsyncLogger()
+    : slots(new Slot[LOG_QUEUE_CAPACITY]), mask(LOG_QUEUE_CAPACITY - 1),
+      enqueue_pos(0), dequeue_pos(0), written_pos(0), dropped_count(0), reported_drops(0),
+      cached_second(-1), fd(-1), stopping(false), flush_waiters(0) {
+    for (size_t i = 0; i < LOG_QUEUE_CAPACITY; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    cached_stamp[0] = '\0';
+}
+
+AsyncLogger::~AsyncLogger() {
+    close();
+}
+
+bool AsyncLogger::open(const std::string& filename) {
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    stopping = false;
+    writer = std::thread(&AsyncLogger::writerLoop, this);
+    return true;
+}
+
+void AsyncLogger::close() {
+    if (writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void AsyncLogger::log(LogLevel level, const std::string& message) {
+    if (fd < 0) {
+        return;
+    }
+
+    int64_t timestamp_ms = nowMillis();
+    size_t position;
+
+    if (!tryPush(level, timestamp_ms, message, position)) {
+        if (level != LogLevel::ERROR) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Ring is full: write the error directly rather than lose it
+        char stamp[32];
+        formatSecond(timestamp_ms / 1000, stamp, sizeof(stamp));
+        std::string line;
+        formatRecord(line, stamp, static_cast<int>(timestamp_ms % 1000), level,
+                     message.data(), message.size());
+        writeAll(line);
+        return;
+    }
+
+    if (level == LogLevel::ERROR) {
+        // Errors must be on disk before the caller moves on
+        flush_waiters.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.notify_one();
+            flushed.wait(lock, [&] {
+                return written_pos.load(std::memory_order_acquire) > position || stopping;
+            });
+        }
+        flush_waiters.fetch_sub(1);
+    } else if (position - dequeue_pos.load(std::memory_order_relaxed) >= LOG_QUEUE_CAPACITY / 2) {
+        // Wake the writer early instead of letting the ring fill up
+        wake.notify_one();
+    }
+}
+
+bool AsyncLogger::tryPush(LogLevel level, int64_t timestamp_ms, const std::string& message,
+                          size_t& position) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+        slot = &slots[pos & mask];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // Full: the writer has not consumed this slot yet
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->timestamp_ms = timestamp_ms;
+    size_t length = message.size();
+    if (length > LOG_MESSAGE_SIZE) {
+        length = LOG_MESSAGE_SIZE;
+        std::memcpy(slot->text, message.data(), length - 3);
+        std::memcpy(slot->text + length - 3, "...", 3);
+    } else {
+        std::memcpy(slot->text, message.data(), length);
+    }
+    slot->length = static_cast<uint32_t>(length);
+
+    // Publish the slot to the writer
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    position = pos;
+    return true;
+}
+
+void AsyncLogger::writerLoop() {
+    std::string buffer;
+    buffer.reserve(LOG_QUEUE_CAPACITY * 64);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS), [this] {
+                return stopping.load() || flush_waiters.load() > 0 ||
+                    enqueue_pos.load(std::memory_order_relaxed) -
+                        dequeue_pos.load(std::memory_order_relaxed) >= LOG_QUEUE_CAPACITY / 2;
+            });
+        }
+        bool stop = stopping.load();
+
+        buffer.clear();
+        drain(buffer);
+
+        uint64_t drops = dropped_count.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            std::string note = "Log queue full, dropped " + std::to_string(drops - reported_drops) + " record(s)";
+            appendRecord(buffer, LogLevel::ERROR, nowMillis(), note.data(), note.size());
+            reported_drops = drops;
+        }
+
+        if (!buffer.empty()) {
+            writeAll(buffer);
+        }
+        written_pos.store(dequeue_pos.load(std::memory_order_relaxed), std::memory_order_release);
+
+        if (flush_waiters.load() > 0 || stop) {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            flushed.notify_all();
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
+
+size_t AsyncLogger::drain(std::string& buffer) {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    size_t count = 0;
+
+    while (count < LOG_QUEUE_CAPACITY) {
+        Slot* slot = &slots[pos & mask];
+        if (slot->sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;  // Not published yet
+        }
+
+        appendRecord(buffer, slot->level, slot->timestamp_ms, slot->text, slot->length);
+
+        // Hand the slot back to producers for the next lap of the ring
+        slot->sequence.store(pos + mask + 1, std::memory_order_release);
+        pos++;
+        count++;
+    }
+
+    dequeue_pos.store(pos, std::memory_order_relaxed);
+    return count;
+}
+
+void AsyncLogger::appendRecord(std::string& buffer, LogLevel level, int64_t timestamp_ms,
+                               const char* text, size_t length) {
+    // Records arrive in time order, so the date/time part rarely changes
+    int64_t second = timestamp_ms / 1000;
+    if (second != cached_second) {
+        formatSecond(second, cached_stamp, sizeof(cached_stamp));
+        cached_second = second;
+    }
+    formatRecord(buffer, cached_stamp, static_cast<int>(timestamp_ms % 1000), level, text, length);
+}
+
+void AsyncLogger::writeAll(const std::string& buffer) {
+    const char* data = buffer.data();
+    size_t remaining = buffer.size();
+
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // Nowhere left to report the failure
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
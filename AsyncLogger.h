@@ -0,0 +1,106 @@
+/**
+ * @file    AsyncLogger.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Asynchronous file logger backed by a lock-free ring buffer
+ *
+ * @details Declares the log levels and AsyncLogger. Callers copy each
+ *          record into a fixed-size slot of a bounded multi-producer,
+ *          single-consumer ring buffer without taking a lock. A background
+ *          thread formats whole batches and hands each batch to the kernel
+ *          with one write() call. Records are dropped and counted when the
+ *          ring is full. ERROR records are waited on until they are written.
+ *
+ */
+
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+#define LOG_QUEUE_CAPACITY 4096      // Slots in the ring, must be a power of two
+#define LOG_MESSAGE_SIZE 480         // Longer messages are truncated
+#define LOG_FLUSH_INTERVAL_MS 100    // Upper bound on how long a record waits in the ring
+
+// Enum for log levels
+enum class LogLevel {
+    INFO,
+    DEBUG,
+    ERROR
+};
+
+// LogLevel to string conversion
+std::string logLevelToString(LogLevel level);
+
+class AsyncLogger {
+public:
+    AsyncLogger();
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Open the log file for appending and start the writer thread
+    bool open(const std::string& filename);
+
+    // Drain everything still queued, stop the writer thread and close the file
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Queue a record. ERROR records return only once they have been written.
+    void log(LogLevel level, const std::string& message);
+
+    // Records lost because the ring was full
+    uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        int64_t timestamp_ms;
+        uint32_t length;
+        char text[LOG_MESSAGE_SIZE];
+    };
+
+    bool tryPush(LogLevel level, int64_t timestamp_ms, const std::string& message, size_t& position);
+    void writerLoop();
+    size_t drain(std::string& buffer);
+    void appendRecord(std::string& buffer, LogLevel level, int64_t timestamp_ms,
+                      const char* text, size_t length);
+    void writeAll(const std::string& buffer);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;  // Only advanced by the writer thread
+    alignas(64) std::atomic<size_t> written_pos;  // Records up to here are in the file
+
+    std::atomic<uint64_t> dropped_count;
+    uint64_t reported_drops;  // Writer thread only
+
+    // Cached "YYYY-mm-dd HH:MM:SS" for the last second formatted, writer thread only
+    int64_t cached_second;
+    char cached_stamp[32];
+
+    int fd;
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;      // Writer waits here for work
+    std::condition_variable flushed;   // ERROR callers wait here for their record
+    std::atomic<int> flush_waiters;
+};
+
+#endif // ASYNC_LOGGER_H
@@ -18,22 +18,254 @@
 #include <algorithm>
 #include <stdexcept>
 #include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <charconv>
 
-std::string logLevelToString(LogLevel level) {
-    switch (level) {
-        case LogLevel::DEBUG: return "DEBUG";
-        case LogLevel::INFO: return "INFO";
-        case LogLevel::ERROR: return "ERROR";
-        default: return "UNKNOWN";
+// Where command output goes on this thread: std::cout unless a caller of
+// executeCommand supplied its own stream
+static thread_local std::ostream* command_output = nullptr;
+
+static std::ostream& console() {
+    return command_output ? *command_output : std::cout;
+}
+
+// Split one CSV line into fields, honouring double-quoted fields with "" escapes
+static bool parseCsvLine(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool inQuotes = false;
+    
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (inQuotes) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                inQuotes = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            inQuotes = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    
+    // Trim whitespace around every field
+    for (auto& f : fields) {
+        f.erase(0, f.find_first_not_of(" \t"));
+        f.erase(f.find_last_not_of(" \t") + 1);
+    }
+    return !inQuotes;
+}
+
+// Render "in <seconds>s (<rate> rows/sec)" for bulk operation reports
+static std::string formatThroughput(size_t rows, double seconds) {
+    std::ostringstream out;
+    out << "in " << std::fixed << std::setprecision(2) << seconds << "s ("
+        << std::setprecision(0) << (seconds > 0 ? rows / seconds : 0.0) << " rows/sec)";
+    return out.str();
+}
+
+// Turn a free-text keyword into an FTS5 query: every word becomes a quoted
+// prefix term and all terms must match. Returns "" when nothing is searchable.
+static std::string buildMatchQuery(const std::string& keyword) {
+    std::string query;
+    std::string token;
+    
+    auto flush = [&]() {
+        if (!token.empty()) {
+            if (!query.empty()) {
+                query += ' ';
+            }
+            query += '"' + token + "\"*";
+            token.clear();
+        }
+    };
+    
+    // Same word boundaries as the unicode61 tokenizer for ASCII input
+    for (unsigned char c : keyword) {
+        if (std::isalnum(c) || c >= 0x80) {
+            token += static_cast<char>(c);
+        } else {
+            flush();
+        }
+    }
+    flush();
+    return query;
+}
+
+// Quote a CSV field only when it contains a separator, quote or line break
+static void writeCsvField(std::ostream& out, std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out << field;
+        return;
+    }
+    
+    out << '"';
+    for (char c : field) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+// Keyset bounds are always bound as values ("no bound" = smallest id, LIMIT -1)
+// so every page of a query shares one prepared statement
+static sqlite3_int64 pageLowerBound(const PageOptions& page) {
+    return page.after_id ? *page.after_id : std::numeric_limits<sqlite3_int64>::min();
+}
+
+static sqlite3_int64 pageLimit(const PageOptions& page) {
+    return page.limit > 0 ? static_cast<sqlite3_int64>(page.limit) : -1;
+}
+
+// Ask for one row more than the page so we know whether another page follows
+static PageOptions probePage(const PageOptions& page) {
+    PageOptions probe = page;
+    if (probe.limit > 0) {
+        probe.limit++;
+    }
+    return probe;
+}
+
+// Print up to limit rows (0 = all) of a cursor or result set under a title and
+// header. Sets nextAfter to the last printed id when rows were left over.
+template <typename Rows>
+static size_t printPage(Rows& results, size_t limit, const std::string& title,
+                        std::optional<int>& nextAfter, OutputSink& sink) {
+    size_t shown = 0;
+    int lastId = 0;
+    
+    for (const BookView& book : results) {
+        if (limit > 0 && shown == limit) {
+            nextAfter = lastId;
+            break;
+        }
+        if (shown == 0) {
+            sink.note(title);
+            sink.header();
+        }
+        sink.row(book.id, book.title, book.author);
+        lastId = book.id;
+        shown++;
+    }
+    return shown;
+}
+
+// Copy every row of a cursor out of SQLite's buffers, into one arena
+static BookResults collectBooks(BookArchive::Cursor results, const PageOptions& page) {
+    BookResults books;
+    books.reserve(std::min<size_t>(page.limit, BOOK_RESULTS_MAX_RESERVE));
+    for (const BookView& book : results) {
+        books.add(book);
+    }
+    return books;
+}
+
+// Parse a --format <table|tsv|json> option if one comes next
+static bool parseFormatOption(CommandTokenizer& args, OutputFormat& format, std::string& error) {
+    if (args.peek() != "--format") {
+        return true;
+    }
+    args.next();
+    
+    std::string_view name = args.next();
+    if (!OutputSink::parseFormat(name, format)) {
+        error = "Invalid value for --format: '" + std::string(name) + "' (expected table, tsv or json)";
+        return false;
+    }
+    return true;
+}
+
+// Parse leading [--after <id>] [--limit N] [--format F] options, leaving the
+// rest of the line to the caller
+static bool parsePageOptions(CommandTokenizer& args, PageOptions& page, OutputFormat& format, std::string& error) {
+    for (;;) {
+        std::string_view option = args.peek();
+        if (option == "--format") {
+            if (!parseFormatOption(args, format, error)) {
+                return false;
+            }
+            continue;
+        }
+        if (option != "--after" && option != "--limit") {
+            return true;
+        }
+        args.next();
+        
+        std::string_view value = args.next();
+        if (value.empty()) {
+            error = "Missing value after " + std::string(option);
+            return false;
+        }
+        
+        bool valid;
+        if (option == "--after") {
+            int after = 0;
+            valid = CommandTokenizer::parseNumber(value, after);
+            if (valid) {
+                page.after_id = after;
+            }
+        } else {
+            valid = CommandTokenizer::parseNumber(value, page.limit);
+        }
+        if (!valid) {
+            error = "Invalid value for " + std::string(option) + ": " + std::string(value);
+            return false;
+        }
+    }
+}
+
+// contains_text(text, needle): text contains needle, ignoring ASCII case. Replaces
+// LIKE '%needle%', which SQLite matches a byte at a time. The needle is the same
+// for every row, so its TextScan is kept as auxiliary data of the statement.
+static void containsText(sqlite3_context* context, int, sqlite3_value** argv) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    if (!text) {
+        sqlite3_result_null(context);
+        return;
     }
+    std::string_view haystack(text, static_cast<size_t>(sqlite3_value_bytes(argv[0])));
+    
+    auto* scan = static_cast<TextScan*>(sqlite3_get_auxdata(context, 1));
+    if (!scan) {
+        const char* needle = reinterpret_cast<const char*>(sqlite3_value_text(argv[1]));
+        TextScan once(std::string_view(needle ? needle : "", static_cast<size_t>(sqlite3_value_bytes(argv[1]))));
+        sqlite3_result_int(context, once.matches(haystack));
+        
+        // SQLite may free it right away, so it is only used from the next row on
+        sqlite3_set_auxdata(context, 1, new TextScan(std::move(once)), 
+                            [](void* data) { delete static_cast<TextScan*>(data); });
+        return;
+    }
+    sqlite3_result_int(context, scan->matches(haystack));
 }
 
-BookArchive::BookArchive(const std::string& db_file, LogLevel log_level)
-    : db(nullptr), db_filename(db_file), running(true), current_log_level(log_level) {
+static bool registerContainsText(sqlite3* handle) {
+    return sqlite3_create_function(handle, "contains_text", 2, SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS,
+                                   nullptr, &containsText, nullptr, nullptr) == SQLITE_OK;
+}
+
+BookArchive::BookArchive(const std::string& db_file, LogLevel log_level, size_t read_connections,
+                         const DatabaseConfig& config)
+    : db(nullptr), db_filename(db_file), running(true), current_log_level(log_level), fts_enabled(false),
+      config(config), output_format(OutputFormat::TABLE), read_pool_size(read_connections), snapshot_mode(false),
+      writer_busy{this, config.busy_timeout, false}, reader_busy{this, config.busy_timeout, false}, writer_stopping(config.read_only),
+      suggest_ready(false), suggest_uncommitted(false) {
     
-    // Open log file
-    log_file.open("book_archive.log", std::ios::app);
-    if (!log_file.is_open()) {
+    // Open log file and start the background writer
+    if (!logger.open("book_archive.log")) {
         std::cerr << "Warning: Could not open log file. Logging disabled." << std::endl;
     }
     
@@ -41,578 +273,3025 @@ BookArchive::BookArchive(const std::string& db_file, LogLevel log_level)
     if (!initializeDatabase()) {
         throw std::runtime_error("Failed to initialize database: " + db_filename);
     }
+    
+    // In-memory databases are private to the writer connection
+    if (db_filename.empty() || db_filename == ":memory:") {
+        read_pool_size = 0;
+    }
+    
+    // Read connections are opened after the schema exists and WAL is enabled
+    std::string error;
+    auto configureReader = [this](sqlite3* handle) {
+        for (const std::string& pragma : this->config.readerPragmas()) {
+            sqlite3_exec(handle, pragma.c_str(), nullptr, nullptr, nullptr);  // Tuning only
+        }
+        sqlite3_busy_handler(handle, &BookArchive::busyHandler, &reader_busy);
+        registerContainsText(handle);
+    };
+    if (read_pool_size > 0 && !read_pool.open(db_filename, read_pool_size, error, configureReader)) {
+        log(LogLevel::ERROR, error + ". Queries will use the writer connection.");
+        read_pool_size = 0;
+    }
+    query_executor.configure(read_pool_size);
+    
+    // Read-only: no writer, no checkpoints, nothing to compact
+    if (writable()) {
+        startMaintenance();
+        writer_thread = std::thread(&BookArchive::writerLoop, this);
+        
+        // Drop deletions no consumer should still need
+        compactChanges();
+    }
+    
+    log(LogLevel::INFO, "********************************************************");
+    log(LogLevel::INFO, "Book Archive initialized with database: " + db_filename + " and logging level: " + logLevelToString(log_level) +
+        ", read connections: " + std::to_string(read_pool_size) + ", profile: " + config.profile +
+        (config.customized ? " (customized)" : "") + (config.read_only ? ", read-only" : ""));
+}
+
+BookArchive::BookArchive(const SnapshotFile& snapshot_file, LogLevel log_level)
+    : db(nullptr), db_filename(snapshot_file.path), running(true), current_log_level(log_level), fts_enabled(false),
+      output_format(OutputFormat::TABLE), read_pool_size(0), snapshot_mode(true), writer_busy{this, 0, false}, reader_busy{this, 0, false}, writer_stopping(true),
+      suggest_ready(false), suggest_uncommitted(false) {
+    
+    if (!logger.open("book_archive.log")) {
+        std::cerr << "Warning: Could not open log file. Logging disabled." << std::endl;
+    }
+    
+    std::string error;
+    if (!snapshot.open(snapshot_file.path, error)) {
+        log(LogLevel::ERROR, error);
+        logger.close();
+        throw std::runtime_error(error);
+    }
+    
     log(LogLevel::INFO, "********************************************************");
-    log(LogLevel::INFO, "Book Archive initialized with database: " + db_filename + " and logging level: " + logLevelToString(log_level));
+    // Snapshot reads take no locks, so they scale with the cores
+    query_executor.configure(std::thread::hardware_concurrency());
+    
+    log(LogLevel::INFO, "Book Archive serving snapshot: " + db_filename + " (" + std::to_string(snapshot.size()) + 
+        " books) with logging level: " + logLevelToString(log_level));
 }
 
 BookArchive::~BookArchive() {
     log(LogLevel::INFO, "Shutting down Book Archive");
     
+    // Finish the queued reads while the connections are still open. They may
+    // queue writes, which the writer commits below.
+    query_executor.stop();
+    
+    // Commit whatever is still queued, then stop the writer thread
+    {
+        std::lock_guard<std::mutex> lock(write_queue_mutex);
+        writer_stopping = true;
+    }
+    write_queue_ready.notify_all();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+    
+    // No checkpoint or ANALYZE may run past this point; SQLite checkpoints on
+    // close. PRAGMA optimize analyzes whatever the queries of this session
+    // would have planned better with fresh statistics.
+    maintenance.stop();
+    if (db && writable()) {
+        executeRawSQL("PRAGMA optimize;");
+    }
+    
     // Clean up prepared statements
     cleanupStatements();
     
+    // Close readers first so the writer can checkpoint the WAL on close
+    read_pool.close();
+    
     // Close database connection
     if (db) {
         sqlite3_close(db);
         db = nullptr;
     }
     
-    // Close log file
-    if (log_file.is_open()) {
-        log_file.close();
-    }
+    // Write out queued records and close log file
+    logger.close();
 }
 
 bool BookArchive::initializeDatabase() {
     std::lock_guard<std::shared_mutex> lock(db_mutex);
     
-    // Open database connection
-    int rc = sqlite3_open(db_filename.c_str(), &db);
+    // Open database connection; a read-only archive must already exist
+    int flags = config.read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    int rc = sqlite3_open_v2(db_filename.c_str(), &db, flags, nullptr);
     if (rc != SQLITE_OK) {
         log(LogLevel::ERROR, "Cannot open database: " + std::string(sqlite3_errmsg(db)));
         sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+    stmt_cache.attach(db);
+    sqlite3_busy_handler(db, &BookArchive::busyHandler, &writer_busy);
+    if (!registerContainsText(db)) {
+        log(LogLevel::ERROR, "Failed to register contains_text: " + std::string(sqlite3_errmsg(db)));
         return false;
     }
     
-    // Enable foreign keys and other pragmas for better performance
-    const char* pragmas[] = {
+    // Fixed settings first, then the tuning of the configured profile
+    std::vector<std::string> pragmas = {
         "PRAGMA foreign_keys = ON;",
-        "PRAGMA journal_mode = WAL;",
-        "PRAGMA synchronous = NORMAL;",
-        "PRAGMA cache_size = 1000;",
         "PRAGMA temp_store = MEMORY;"
     };
-
+    std::vector<std::string> tuning = config.read_only ? config.readerPragmas() : config.writerPragmas();
+    pragmas.insert(pragmas.end(), tuning.begin(), tuning.end());
+    
     for (const auto& pragma : pragmas) {
         char* errmsg = nullptr;
-        rc = sqlite3_exec(db, pragma, nullptr, nullptr, &errmsg);
+        rc = sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, &errmsg);
         if (rc != SQLITE_OK) {
             log(LogLevel::ERROR, "Failed to set pragma: " + std::string(errmsg));
             sqlite3_free(errmsg);
             // Continue despite pragma errors - they're optimizations
         }
-    }
-    
-    // Create books table if it doesn't exist
-    const char* createTableSQL = 
-        "CREATE TABLE IF NOT EXISTS books ("
-        "id INTEGER PRIMARY KEY, "
-        "title TEXT NOT NULL, "
-        "author TEXT NOT NULL, "
-        "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP);";
+    }
+    
+    if (config.read_only) {
+        return checkSchema();
+    }
+    
+    // An archive stamped with this version has every table, index and trigger:
+    // no DDL runs and nothing is locked. An older stamp is upgraded, a newer one
+    // is left alone.
+    std::optional<sqlite3_int64> version = queryInt("PRAGMA user_version;");
+    if (version && *version >= SCHEMA_VERSION) {
+        fts_enabled = true;  // Only stamped once the full-text index was set up
+    } else if (!createSchema()) {
+        return false;
+    }
+    
+    return initializeSuggestHooks();
+}
+
+bool BookArchive::createSchema() {
+    // Databases from before the authors table keep author text on every row
+    if (!migrateAuthors()) {
+        return false;
+    }
+    
+    // Each author name is stored once; books refer to it by id
+    const char* schema[] = {
+        "CREATE TABLE IF NOT EXISTS authors ("
+        "id INTEGER PRIMARY KEY, "
+        "name TEXT NOT NULL UNIQUE);",
+        
+        "CREATE TABLE IF NOT EXISTS books ("
+        "id INTEGER PRIMARY KEY, "
+        "title TEXT NOT NULL, "
+        "author_id INTEGER NOT NULL REFERENCES authors(id), "
+        "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP);",
+        
+        // Books as the rest of the code sees them, with the author name joined in
+        "CREATE VIEW IF NOT EXISTS book_rows AS "
+        "SELECT b.id AS id, b.title AS title, a.name AS author, b.created_at AS created_at "
+        "FROM books b JOIN authors a ON a.id = b.author_id;",
+        
+        // Writes go through the view: the author is interned, then the book points at it
+        "CREATE TRIGGER IF NOT EXISTS book_rows_insert INSTEAD OF INSERT ON book_rows BEGIN "
+        "INSERT OR IGNORE INTO authors(name) VALUES (new.author); "
+        "INSERT INTO books(id, title, author_id) "
+        "VALUES (new.id, new.title, (SELECT id FROM authors WHERE name = new.author)); END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS book_rows_update INSTEAD OF UPDATE ON book_rows BEGIN "
+        "INSERT OR IGNORE INTO authors(name) VALUES (new.author); "
+        "UPDATE books SET title = new.title, author_id = (SELECT id FROM authors WHERE name = new.author) "
+        "WHERE id = old.id; END;",
+        
+        // An author goes with their last book. The full-text and suggest triggers
+        // still look the old name up, so these must fire last: SQLite runs temp
+        // triggers first, then a table's triggers newest first, and the full-text
+        // ones are always created after these.
+        "CREATE TRIGGER IF NOT EXISTS authors_gc_ad AFTER DELETE ON books BEGIN "
+        "DELETE FROM authors WHERE id = old.author_id "
+        "AND NOT EXISTS (SELECT 1 FROM books WHERE author_id = old.author_id); END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS authors_gc_au AFTER UPDATE OF author_id ON books "
+        "WHEN old.author_id != new.author_id BEGIN "
+        "DELETE FROM authors WHERE id = old.author_id "
+        "AND NOT EXISTS (SELECT 1 FROM books WHERE author_id = old.author_id); END;"
+    };
+    
+    char* errmsg = nullptr;
+    int rc;
+    for (const auto& sql : schema) {
+        rc = sqlite3_exec(db, sql, nullptr, nullptr, &errmsg);
+        if (rc != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to create schema: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            return false;
+        }
+    }
+    
+    // Author lookups walk this index in id order, which keyset paging relies on
+    const char* indexes[] = {
+        "CREATE INDEX IF NOT EXISTS idx_books_author_id ON books(author_id);",
+        "CREATE INDEX IF NOT EXISTS idx_books_title ON books(title);"
+    };
+    
+    for (const auto& sql : indexes) {
+        rc = sqlite3_exec(db, sql, nullptr, nullptr, &errmsg);
+        if (rc != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to create index: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            // Continue despite index creation error
+        }
+    }
+    
+    // Authors whose books were all deleted or renamed before authors_gc_* existed
+    if (!executeRawSQL("DELETE FROM authors WHERE id NOT IN (SELECT author_id FROM books);")) {
+        log(LogLevel::ERROR, "Failed to drop authors without books");
+    }
+    
+    // Full-text index is optional - searchBook falls back to a substring scan without it
+    fts_enabled = initializeFullTextIndex();
+    
+    if (!initializeChangeLog()) {
+        return false;
+    }
+    
+    // Without the full-text index every open tries again
+    std::string stamp = "PRAGMA user_version = " + std::to_string(SCHEMA_VERSION) + ";";
+    if (fts_enabled && !executeRawSQL(stamp.c_str())) {
+        log(LogLevel::ERROR, "Failed to record the schema version");
+    }
+    return true;
+}
+
+bool BookArchive::checkSchema() {
+    bool archive = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT name FROM sqlite_master WHERE name IN ('book_rows', 'books_fts');",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string_view name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            archive = archive || name == "book_rows";
+            fts_enabled = fts_enabled || name == "books_fts";
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    if (!archive) {
+        log(LogLevel::ERROR, "Cannot open read-only: " + db_filename + " has no archive schema, or is too old. "
+            "Open it read-write once to create or upgrade it.");
+        return false;
+    }
+    return true;
+}
+
+bool BookArchive::migrateAuthors() {
+    // A books table with an author column is the old layout
+    bool legacy = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM pragma_table_info('books') WHERE name = 'author';",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        legacy = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+    if (!legacy) {
+        return true;
+    }
+    
+    log(LogLevel::INFO, "Migrating books to the authors table");
+    
+    // The old index, FTS table and triggers all name books.author, so they are rebuilt
+    const char* migration[] = {
+        "BEGIN IMMEDIATE;",
+        "DROP TRIGGER IF EXISTS books_fts_ai;",
+        "DROP TRIGGER IF EXISTS books_fts_ad;",
+        "DROP TRIGGER IF EXISTS books_fts_au;",
+        "DROP TABLE IF EXISTS books_fts;",
+        "DROP INDEX IF EXISTS idx_books_title_author;",
+        
+        "CREATE TABLE IF NOT EXISTS authors ("
+        "id INTEGER PRIMARY KEY, "
+        "name TEXT NOT NULL UNIQUE);",
+        "INSERT OR IGNORE INTO authors(name) SELECT author FROM books GROUP BY author ORDER BY MIN(id);",
+        
+        "CREATE TABLE books_migrated ("
+        "id INTEGER PRIMARY KEY, "
+        "title TEXT NOT NULL, "
+        "author_id INTEGER NOT NULL REFERENCES authors(id), "
+        "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP);",
+        "INSERT INTO books_migrated(id, title, author_id, created_at) "
+        "SELECT b.id, b.title, a.id, b.created_at FROM books b JOIN authors a ON a.name = b.author;",
+        
+        "DROP TABLE books;",
+        "ALTER TABLE books_migrated RENAME TO books;",
+        "COMMIT;"
+    };
+    
+    char* errmsg = nullptr;
+    for (const auto& sql : migration) {
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Author migration failed: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    
+    // Hand the pages the repeated author text used back to the file system
+    if (sqlite3_exec(db, "VACUUM;", nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to vacuum after author migration: " + std::string(errmsg));
+        sqlite3_free(errmsg);
+    }
+    
+    log(LogLevel::INFO, "Author migration finished");
+    return true;
+}
+
+bool BookArchive::initializeFullTextIndex() {
+    // Remember whether the index already existed so new ones get backfilled
+    bool exists = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'books_fts';",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+    
+    // External content table: the index stores tokens only, rows live in books
+    const char* ftsSchema[] = {
+        "CREATE VIRTUAL TABLE IF NOT EXISTS books_fts USING fts5("
+        "title, author, content='book_rows', content_rowid='id', "
+        "tokenize='unicode61 remove_diacritics 2', prefix='2 3');",
+        
+        // Recreated so they are newer than authors_gc_* in archives from before those
+        "DROP TRIGGER IF EXISTS books_fts_ad;",
+        "DROP TRIGGER IF EXISTS books_fts_au;",
+        
+        "CREATE TRIGGER IF NOT EXISTS books_fts_ai AFTER INSERT ON books BEGIN "
+        "INSERT INTO books_fts(rowid, title, author) "
+        "SELECT new.id, new.title, name FROM authors WHERE id = new.author_id; END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS books_fts_ad AFTER DELETE ON books BEGIN "
+        "INSERT INTO books_fts(books_fts, rowid, title, author) "
+        "SELECT 'delete', old.id, old.title, name FROM authors WHERE id = old.author_id; END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS books_fts_au AFTER UPDATE ON books BEGIN "
+        "INSERT INTO books_fts(books_fts, rowid, title, author) "
+        "SELECT 'delete', old.id, old.title, name FROM authors WHERE id = old.author_id; "
+        "INSERT INTO books_fts(rowid, title, author) "
+        "SELECT new.id, new.title, name FROM authors WHERE id = new.author_id; END;"
+    };
+    
+    char* errmsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN;", nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to begin full-text index setup: " + std::string(errmsg));
+        sqlite3_free(errmsg);
+        return false;
+    }
+    
+    for (const auto& sql : ftsSchema) {
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Full-text search unavailable, using substring search: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    
+    // Migration for databases created before the index existed
+    if (!exists) {
+        log(LogLevel::INFO, "Backfilling full-text index from books table");
+        if (sqlite3_exec(db, "INSERT INTO books_fts(books_fts) VALUES ('rebuild');",
+                         nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to backfill full-text index: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to commit full-text index setup: " + std::string(errmsg));
+        sqlite3_free(errmsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+bool BookArchive::initializeChangeLog() {
+    bool exists = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'book_changes';",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+    }
+    sqlite3_finalize(stmt);
+    
+    // One entry per book, its latest change: a new change deletes the old entry,
+    // so the log compacts itself. AUTOINCREMENT keeps seq from reusing the
+    // number of a deleted last entry, which a consumer may already have seen.
+    const char* changeSchema[] = {
+        "BEGIN IMMEDIATE;",
+        
+        "CREATE TABLE IF NOT EXISTS book_changes ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "book_id INTEGER NOT NULL UNIQUE, "
+        "op TEXT NOT NULL, "
+        "changed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP);",
+        
+        // Highest seq of a deletion compactChanges() has dropped
+        "CREATE TABLE IF NOT EXISTS book_changes_state ("
+        "id INTEGER PRIMARY KEY CHECK (id = 1), "
+        "purged_seq INTEGER NOT NULL);",
+        "INSERT OR IGNORE INTO book_changes_state(id, purged_seq) VALUES (1, 0);",
+        
+        // Lets compactChanges() find old deletions without reading the whole log. Not
+        // a partial index: ANALYZE keeps no statistics for an empty one, and PRAGMA
+        // optimize would then analyze the whole log on every close.
+        "CREATE INDEX IF NOT EXISTS idx_book_changes_op ON book_changes(op, changed_at);",
+        
+        "CREATE TRIGGER IF NOT EXISTS book_changes_ai AFTER INSERT ON books BEGIN "
+        "DELETE FROM book_changes WHERE book_id = new.id; "
+        "INSERT INTO book_changes(book_id, op) VALUES (new.id, 'insert'); END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS book_changes_au AFTER UPDATE ON books BEGIN "
+        "DELETE FROM book_changes WHERE book_id IN (old.id, new.id); "
+        "INSERT INTO book_changes(book_id, op) SELECT old.id, 'delete' WHERE old.id != new.id; "
+        "INSERT INTO book_changes(book_id, op) VALUES (new.id, 'update'); END;",
+        
+        "CREATE TRIGGER IF NOT EXISTS book_changes_ad AFTER DELETE ON books BEGIN "
+        "DELETE FROM book_changes WHERE book_id = old.id; "
+        "INSERT INTO book_changes(book_id, op) VALUES (old.id, 'delete'); END;"
+    };
+    
+    char* errmsg = nullptr;
+    for (const auto& sql : changeSchema) {
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to create the change log: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    
+    // Books from before the change log, so a consumer starting at 0 sees them all
+    if (!exists) {
+        log(LogLevel::INFO, "Backfilling the change log from books table");
+        if (sqlite3_exec(db, "INSERT INTO book_changes(book_id, op) SELECT id, 'insert' FROM books ORDER BY id;",
+                         nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to backfill the change log: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+    
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errmsg) != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to commit the change log setup: " + std::string(errmsg));
+        sqlite3_free(errmsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+bool BookArchive::initializeSuggestHooks() {
+    // Temp triggers live with this connection only, so every open recreates them
+    const char* triggers[] = {
+        "CREATE TEMP TRIGGER IF NOT EXISTS suggest_books_ai AFTER INSERT ON main.books BEGIN "
+        "SELECT suggest_change(NULL, NULL, new.title, name) FROM main.authors WHERE id = new.author_id; END;",
+        
+        "CREATE TEMP TRIGGER IF NOT EXISTS suggest_books_ad AFTER DELETE ON main.books BEGIN "
+        "SELECT suggest_change(old.title, name, NULL, NULL) FROM main.authors WHERE id = old.author_id; END;",
+        
+        "CREATE TEMP TRIGGER IF NOT EXISTS suggest_books_au AFTER UPDATE OF title, author_id ON main.books BEGIN "
+        "SELECT suggest_change(old.title, (SELECT name FROM main.authors WHERE id = old.author_id), "
+        "new.title, (SELECT name FROM main.authors WHERE id = new.author_id)); END;"
+    };
+    
+    int rc = sqlite3_create_function(db, "suggest_change", 4, SQLITE_UTF8, this, 
+                                     &BookArchive::suggestChange, nullptr, nullptr);
+    if (rc != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to register suggest_change: " + std::string(sqlite3_errmsg(db)));
+        return false;
+    }
+    
+    char* errmsg = nullptr;
+    for (const char* sql : triggers) {
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+            log(LogLevel::ERROR, "Failed to create suggest trigger: " + std::string(errmsg));
+            sqlite3_free(errmsg);
+            return false;
+        }
+    }
+    
+    sqlite3_commit_hook(db, &BookArchive::suggestCommit, this);
+    sqlite3_rollback_hook(db, &BookArchive::suggestRollback, this);
+    return true;
+}
+
+bool BookArchive::isLogEnabled(LogLevel level) const {
+    // Skip logging if the level is below current_log_level
+    if (level < current_log_level) {
+        return false;
+    }
+    
+    // Skip all non-error logs in release mode
+    #ifndef DEBUG_MODE
+    if (level != LogLevel::ERROR) {
+        return false;
+    }
+    #endif
+    
+    return true;
+}
+
+void BookArchive::log(LogLevel level, const std::string& message) {
+    if (!isLogEnabled(level)) {
+        return;
+    }
+    
+    // Formatting and file I/O happen on the logger's own thread
+    logger.log(level, message);
+}
+
+void BookArchive::cleanupStatements() {
+    StatementCache::Counters writer = stmt_cache.counters();
+    StatementCache::Counters readers = read_pool.statementCounters();
+    log(LogLevel::INFO, "Statement cache (writer/readers): hits=" + std::to_string(writer.hits) + "/" + 
+        std::to_string(readers.hits) + ", misses=" + std::to_string(writer.misses) + "/" + 
+        std::to_string(readers.misses) + ", prepares=" + std::to_string(writer.prepares) + "/" + 
+        std::to_string(readers.prepares) + ", evictions=" + std::to_string(writer.evictions) + "/" + 
+        std::to_string(readers.evictions));
+    
+    BookCache::Counters books = book_cache.counters();
+    log(LogLevel::INFO, "Book cache: hits=" + std::to_string(books.hits) + ", misses=" + 
+        std::to_string(books.misses) + ", evictions=" + std::to_string(books.evictions) + 
+        ", invalidations=" + std::to_string(books.invalidations));
+    
+    stmt_cache.clear();
+}
+
+StatementCache::Lease BookArchive::getPreparedStatement(const std::string& sql) {
+    std::string error;
+    StatementCache::Lease stmt = stmt_cache.acquire(sql, error);
+    if (!stmt) {
+        log(LogLevel::ERROR, error);
+    }
+    return stmt;
+}
+
+bool BookArchive::executeBound(const std::string& sql, BindFn bind, const void* args) {
+    if (isLogEnabled(LogLevel::DEBUG)) {
+        log(LogLevel::DEBUG, "Executing SQL: " + sql);
+    }
+    
+    stats.countExecute();
+    
+    ArchiveStats::Timer prepare_timer;
+    StatementCache::Lease lease = getPreparedStatement(sql);
+    stats.record(ArchiveStats::PREPARE, prepare_timer);
+    if (!lease) {
+        return false;
+    }
+    sqlite3_stmt* stmt = lease.get();
+    
+    ArchiveStats::Timer bind_timer;
+    int rc = bind(stmt, args, SQLITE_STATIC);
+    stats.record(ArchiveStats::BIND, bind_timer);
+    if (rc != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to bind parameters: " + std::string(sqlite3_errstr(rc)) + " for SQL: " + sql);
+        return false;
+    }
+    
+    // Locks are waited for in busyHandler, so SQLITE_BUSY here means it timed out
+    rc = stepStatement(stmt);
+    if (rc != SQLITE_DONE) {
+        log(LogLevel::ERROR, "Failed to execute SQL: " + std::string(sqlite3_errmsg(db)));
+        return false;
+    }
+    return true;
+}
+
+std::optional<sqlite3_int64> BookArchive::queryIntBound(const std::string& sql, BindFn bind, const void* args) {
+    StatementCache::Lease lease = getPreparedStatement(sql);
+    if (!lease) {
+        return std::nullopt;
+    }
+    sqlite3_stmt* stmt = lease.get();
+    
+    int rc = bind(stmt, args, SQLITE_STATIC);
+    if (rc != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to bind parameters: " + std::string(sqlite3_errstr(rc)) + " for SQL: " + sql);
+        return std::nullopt;
+    }
+    
+    rc = stepStatement(stmt);
+    if (rc == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        return sqlite3_column_int64(stmt, 0);
+    }
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        log(LogLevel::ERROR, "Failed to execute SQL: " + std::string(sqlite3_errmsg(db)));
+    }
+    return std::nullopt;
+}
+
+std::vector<Book> BookArchive::queryBound(const std::string& sql, BindFn bind, const void* args) {
+    std::vector<Book> results;
+    
+    // Rows are copied out before returning, so arguments can be bound in place
+    Cursor rows = cursorBound(sql, bind, args, SQLITE_STATIC);
+    while (rows.next()) {
+        results.push_back(rows.current().toBook());
+    }
+    
+    if (isLogEnabled(LogLevel::DEBUG)) {
+        log(LogLevel::DEBUG, "Query returned " + std::to_string(results.size()) + " results");
+    }
+    
+    return results;
+}
+
+BookArchive::Cursor BookArchive::cursorBound(const std::string& sql, BindFn bind, const void* args,
+                                             sqlite3_destructor_type lifetime) {
+    if (isLogEnabled(LogLevel::DEBUG)) {
+        log(LogLevel::DEBUG, "Executing query: " + sql);
+    }
+    
+    stats.countQuery();
+    
+    Cursor cursor;
+    cursor.owner = this;
+    cursor.error = true;  // Until the statement is ready to step
+    std::string error;
+    
+    // Includes waiting for a connection, which is part of what a query pays
+    ArchiveStats::Timer prepare_timer;
+    if (read_pool_size > 0) {
+        // The leased connection belongs to this cursor until it finishes
+        cursor.conn = read_pool.acquire();
+        cursor.handle = cursor.conn->handle;
+        cursor.stmt = cursor.conn->statements.acquire(sql, error);
+    } else {
+        // Without read connections queries run on the writer connection
+        cursor.writer_lock = std::unique_lock<std::shared_mutex>(db_mutex);
+        cursor.handle = db;
+        cursor.stmt = stmt_cache.acquire(sql, error);
+    }
+    stats.record(ArchiveStats::PREPARE, prepare_timer);
+    
+    if (!cursor.stmt) {
+        log(LogLevel::ERROR, error);
+        cursor.finish();
+        return cursor;
+    }
+    
+    ArchiveStats::Timer bind_timer;
+    int rc = bind(cursor.stmt.get(), args, lifetime);
+    stats.record(ArchiveStats::BIND, bind_timer);
+    if (rc != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to bind parameters: " + std::string(sqlite3_errstr(rc)) + " for SQL: " + sql);
+        cursor.finish();
+        return cursor;
+    }
+    
+    cursor.error = false;
+    return cursor;
+}
+
+BookArchive::Cursor& BookArchive::Cursor::operator=(Cursor&& other) noexcept {
+    if (this != &other) {
+        finish();
+        owner = other.owner;
+        conn = std::move(other.conn);
+        writer_lock = std::move(other.writer_lock);
+        stmt = std::move(other.stmt);
+        handle = other.handle;
+        row = other.row;
+        rows = other.rows;
+        error = other.error;
+        source = other.source;
+        source_index = other.source_index;
+        source_end = other.source_end;
+        source_remaining = other.source_remaining;
+        source_scan = std::move(other.source_scan);
+        source_author = std::move(other.source_author);
+        source_exact = other.source_exact;
+        other.source = nullptr;
+    }
+    return *this;
+}
+
+bool BookArchive::Cursor::next() {
+    if (source) {
+        while (source_index < source_end && source_remaining > 0) {
+            BookView book = source->at(source_index++);
+            bool match = source_exact ? book.author == source_author :
+                         source_scan.matches(book.title) || source_scan.matches(book.author);
+            if (match) {
+                row = book;
+                rows++;
+                source_remaining--;
+                return true;
+            }
+        }
+        finish();
+        return false;
+    }
+    
+    if (!stmt) {
+        return false;
+    }
+    
+    // A locked database is waited for in busyHandler
+    int rc = owner->stepStatement(stmt.get());
+    if (rc == SQLITE_ROW) {
+        ArchiveStats::Timer materialize_timer;
+        sqlite3_stmt* s = stmt.get();
+        const char* title = reinterpret_cast<const char*>(sqlite3_column_text(s, 1));
+        const char* author = reinterpret_cast<const char*>(sqlite3_column_text(s, 2));
+        
+        row.id = sqlite3_column_int(s, 0);
+        row.title = title ? std::string_view(title, sqlite3_column_bytes(s, 1)) : std::string_view();
+        row.author = author ? std::string_view(author, sqlite3_column_bytes(s, 2)) : std::string_view();
+        rows++;
+        owner->stats.record(ArchiveStats::MATERIALIZE, materialize_timer);
+        owner->stats.countRow();
+        return true;
+    }
+    
+    if (rc != SQLITE_DONE) {
+        owner->log(LogLevel::ERROR, "Failed to execute query: " + std::string(sqlite3_errmsg(handle)));
+        error = true;
+    }
+    
+    // Hand the connection back as soon as the rows run out
+    finish();
+    return false;
+}
+
+int64_t BookArchive::Cursor::columnInt(int index) const {
+    return stmt ? sqlite3_column_int64(stmt.get(), index) : 0;
+}
+
+std::string_view BookArchive::Cursor::columnText(int index) const {
+    const char* text = stmt ? reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), index)) : nullptr;
+    return text ? std::string_view(text, sqlite3_column_bytes(stmt.get(), index)) : std::string_view();
+}
+
+void BookArchive::Cursor::finish() {
+    row = BookView{0, {}, {}};
+    source = nullptr;
+    stmt = StatementCache::Lease();
+    conn = ConnectionPool::Lease();
+    if (writer_lock.owns_lock()) {
+        writer_lock.unlock();
+    }
+}
+
+static const std::string INSERT_BOOK_SQL = "INSERT INTO book_rows (id, title, author) VALUES (?, ?, ?);";
+static const std::string DELETE_BOOK_SQL = "DELETE FROM books WHERE id = ?;";
+static const std::string UPDATE_BOOK_SQL = "UPDATE book_rows SET title = ?, author = ? WHERE id = ?;";
+
+// Bulk statements take a chunk of ids as one JSON array parameter
+static const std::string DELETE_BOOKS_SQL = "DELETE FROM books WHERE id IN (SELECT value FROM json_each(?));";
+static const std::string COUNT_BOOKS_SQL = "SELECT count(*) FROM books WHERE id IN (SELECT value FROM json_each(?));";
+static const std::string DELETE_RANGE_SQL = "DELETE FROM books WHERE id BETWEEN ? AND ?;";
+// The id batch_size rows into a range (OFFSET batch_size - 1), where its next chunk ends
+static const std::string RANGE_CHUNK_END_SQL = 
+    "SELECT id FROM books WHERE id BETWEEN ? AND ? ORDER BY id LIMIT 1 OFFSET ?;";
+
+// Book id first so change rows fill a BookView; left join because deleted books are gone
+static const std::string CHANGES_SINCE_SQL = 
+    "SELECT c.book_id, b.title, b.author, c.seq, c.op FROM book_changes c "
+    "LEFT JOIN book_rows b ON b.id = c.book_id WHERE c.seq > ? ORDER BY c.seq LIMIT ?;";
+static const std::string PURGED_SEQ_SQL = "SELECT purged_seq, NULL, NULL FROM book_changes_state WHERE id = 1;";
+static const std::string MARK_PURGED_SQL = 
+    "UPDATE book_changes_state SET purged_seq = max(purged_seq, ifnull("
+    "(SELECT max(seq) FROM book_changes WHERE op = 'delete' AND changed_at < datetime('now', ?)), 0)) "
+    "WHERE id = 1;";
+static const std::string PURGE_CHANGES_SQL = 
+    "DELETE FROM book_changes WHERE op = 'delete' AND changed_at < datetime('now', ?);";
+static const std::string PURGEABLE_CHANGES_SQL = 
+    "SELECT EXISTS (SELECT 1 FROM book_changes WHERE op = 'delete' AND changed_at < datetime('now', ?));";
+
+// "[1,2,3]" for json_each
+static void appendIdArray(std::string& out, const int* ids, size_t count) {
+    out.assign(1, '[');
+    char digits[16];
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        auto result = std::to_chars(digits, digits + sizeof(digits), ids[i]);
+        out.append(digits, result.ptr - digits);
+    }
+    out.push_back(']');
+}
+
+std::future<bool> BookArchive::addBookAsync(int id, std::string title, std::string author) {
+    return submitWrite([this, id, title = std::move(title), author = std::move(author)] {
+        return execute(INSERT_BOOK_SQL, id, title, author);
+    }, id);
+}
+
+std::future<bool> BookArchive::deleteBookAsync(int id) {
+    return submitWrite([this, id] {
+        return execute(DELETE_BOOK_SQL, id);
+    }, id);
+}
+
+std::future<bool> BookArchive::updateBookAsync(int id, std::string newTitle, std::string newAuthor) {
+    return submitWrite([this, id, newTitle = std::move(newTitle), newAuthor = std::move(newAuthor)] {
+        return execute(UPDATE_BOOK_SQL, newTitle, newAuthor, id);
+    }, id);
+}
+
+std::future<std::optional<Book>> BookArchive::getBookAsync(int id) {
+    return submitRead([this, id] { return getBook(id); });
+}
+
+std::future<BookResults> BookArchive::listBooksAsync(PageOptions page) {
+    return submitRead([this, page] { return listBooks(page); });
+}
+
+std::future<BookResults> BookArchive::searchBookAsync(std::string keyword, PageOptions page) {
+    return submitRead([this, keyword = std::move(keyword), page] { return searchBook(keyword, page); });
+}
+
+std::future<BookResults> BookArchive::booksByAuthorAsync(std::string author, PageOptions page) {
+    return submitRead([this, author = std::move(author), page] { return booksByAuthor(author, page); });
+}
+
+std::future<BookResults> BookArchive::searchBooksAsync(std::vector<std::string> keywords) {
+    return submitRead([this, keywords = std::move(keywords)] { return searchBooks(keywords); });
+}
+
+bool BookArchive::post(std::function<void(BookArchive&)> task) {
+    return query_executor.submit([this, task = std::move(task)] { task(*this); });
+}
+
+bool BookArchive::addBook(int id, std::string_view title, std::string_view author) {
+    if (rejectWrite("add the book")) {
+        return false;
+    }
+    
+    if (isLogEnabled(LogLevel::INFO)) {
+        log(LogLevel::INFO, "Adding book: ID=" + std::to_string(id) + ", Title='" + std::string(title) + "', Author='" + std::string(author) + "'");
+    }
+    
+    // The caller waits for the result, so the arguments can be used in place
+    bool ok = submitWrite([&] { return execute(INSERT_BOOK_SQL, id, title, author); }, id).get();
+    if (!ok) {
+        log(LogLevel::ERROR, "Failed to add book");
+        console() << "Error: Failed to add the book. Check logs for details." << std::endl;
+        return false;
+    }
+    
+    console() << "Book added successfully!" << std::endl;
+    return true;
+}
+
+bool BookArchive::deleteBook(int id) {
+    if (rejectWrite("delete the book")) {
+        return false;
+    }
+    
+    if (isLogEnabled(LogLevel::INFO)) {
+        log(LogLevel::INFO, "Deleting book with ID: " + std::to_string(id));
+    }
+    
+    bool ok = submitWrite([&] { return execute(DELETE_BOOK_SQL, id); }, id).get();
+    if (!ok) {
+        log(LogLevel::ERROR, "Failed to delete book");
+        console() << "Error: Failed to delete the book. Check logs for details." << std::endl;
+        return false;
+    }
+    
+    console() << "Book deleted successfully!" << std::endl;
+    return true;
+}
+
+bool BookArchive::updateBook(int id, std::string_view newTitle, std::string_view newAuthor) {
+    if (rejectWrite("update the book")) {
+        return false;
+    }
+    
+    if (isLogEnabled(LogLevel::INFO)) {
+        log(LogLevel::INFO, "Updating book: ID=" + std::to_string(id) + 
+            ", New Title='" + std::string(newTitle) + "', New Author='" + std::string(newAuthor) + "'");
+    }
+    
+    bool ok = submitWrite([&] { return execute(UPDATE_BOOK_SQL, newTitle, newAuthor, id); }, id).get();
+    if (!ok) {
+        log(LogLevel::ERROR, "Failed to update book");
+        console() << "Error: Failed to update the book. Check logs for details." << std::endl;
+        return false;
+    }
+    
+    console() << "Book updated successfully!" << std::endl;
+    return true;
+}
+
+bool BookArchive::rejectWrite(const char* operation) {
+    if (writable()) {
+        return false;
+    }
+    const char* reason = snapshot_mode ? "a read-only snapshot" : "opened read-only";
+    log(LogLevel::ERROR, std::string("Refused to ") + operation + ": archive is " + reason);
+    console() << "Error: Cannot " << operation << ", the archive is " << reason << "." << std::endl;
+    return true;
+}
+
+std::future<bool> BookArchive::submitWrite(std::function<bool()> apply, std::optional<int> invalidate_id) {
+    WriteRequest request;
+    request.apply = std::move(apply);
+    request.invalidate_id = invalidate_id;
+    std::future<bool> result = request.result.get_future();
+    
+    {
+        std::lock_guard<std::mutex> lock(write_queue_mutex);
+        if (writer_stopping) {
+            request.result.set_value(false);
+            return result;
+        }
+        write_queue.push_back(std::move(request));
+    }
+    write_queue_ready.notify_one();
+    return result;
+}
+
+void BookArchive::writerLoop() {
+    std::vector<WriteRequest> group;
+    size_t last_group_size = 0;
+    
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(write_queue_mutex);
+            write_queue_ready.wait(lock, [this] { return writer_stopping || !write_queue.empty(); });
+            if (write_queue.empty()) {
+                return;  // Stopping and drained
+            }
+            
+            // The last group had concurrent writers: give them a moment to queue up
+            // again. A lone writer never waits.
+            if (last_group_size > 1 && !writer_stopping) {
+                write_queue_ready.wait_for(lock, std::chrono::microseconds(GROUP_COMMIT_WINDOW_US), [&] {
+                    return writer_stopping || write_queue.size() >= last_group_size ||
+                           write_queue.size() >= GROUP_COMMIT_MAX_WRITES;
+                });
+            }
+            
+            while (!write_queue.empty() && group.size() < GROUP_COMMIT_MAX_WRITES) {
+                group.push_back(std::move(write_queue.front()));
+                write_queue.pop_front();
+            }
+        }
+        
+        last_group_size = group.size();
+        commitWriteGroup(group);
+        group.clear();
+    }
+}
+
+void BookArchive::commitWriteGroup(std::vector<WriteRequest>& group) {
+    std::vector<char> ok(group.size(), 0);
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(db_mutex);
+        
+        // Inside a transaction the caller opened (batch --group) the writes just join it.
+        // Otherwise even a lone write takes the write lock up front with BEGIN IMMEDIATE.
+        bool own_transaction = sqlite3_get_autocommit(db) && beginImmediate(lock);
+        bool locked_out = !own_transaction && sqlite3_get_autocommit(db);
+        if (locked_out) {
+            log(LogLevel::ERROR, "Database locked, failing a group of " + std::to_string(group.size()) + " write(s)");
+        }
+        
+        for (size_t i = 0; i < group.size() && !locked_out; ++i) {
+            try {
+                ok[i] = group[i].apply();
+            } catch (const std::exception& e) {
+                log(LogLevel::ERROR, "Write failed: " + std::string(e.what()));
+            }
+            
+            // A failed statement only undoes itself, but some errors (disk full,
+            // I/O) roll back the whole transaction and everything before it
+            if (own_transaction && sqlite3_get_autocommit(db)) {
+                log(LogLevel::ERROR, "Group transaction rolled back after " + std::to_string(i + 1) + " write(s)");
+                std::fill(ok.begin(), ok.begin() + i + 1, 0);
+                own_transaction = false;
+            }
+        }
+        
+        if (own_transaction && !executeRawSQL("COMMIT;")) {
+            executeRawSQL("ROLLBACK;");
+            std::fill(ok.begin(), ok.end(), 0);
+        }
+        
+        // Only after the commit, or a reader could cache the old row again
+        for (const WriteRequest& request : group) {
+            if (request.invalidate_id) {
+                book_cache.invalidate(*request.invalidate_id);
+            }
+        }
+        search_cache.invalidate();
+    }
+    
+    stats.countWriteGroup(group.size());
+    if (isLogEnabled(LogLevel::DEBUG)) {
+        log(LogLevel::DEBUG, "Committed a group of " + std::to_string(group.size()) + " write(s)");
+    }
+    
+    for (size_t i = 0; i < group.size(); ++i) {
+        group[i].result.set_value(ok[i] != 0);
+    }
+}
+
+std::optional<Book> BookArchive::getBook(int id) {
+    if (snapshot_mode) {
+        // A binary search over the mapped records is already as cheap as the cache
+        std::optional<BookView> found = snapshot.find(id);
+        return found ? std::optional<Book>(found->toBook()) : std::nullopt;
+    }
+    
+    Book book;
+    uint64_t token;
+    if (book_cache.get(id, book, token)) {
+        return book;
+    }
+    
+    static const std::string sql = "SELECT id, title, author FROM book_rows WHERE id = ?;";
+    Cursor row = cursor(sql, id);
+    if (!row.next()) {
+        return std::nullopt;
+    }
+    
+    book = row.current().toBook();
+    book_cache.put(book, token);
+    return book;
+}
+
+BookCache::Counters BookArchive::bookCacheCounters() const {
+    return book_cache.counters();
+}
+
+int BookArchive::stepStatement(sqlite3_stmt* stmt) {
+    ArchiveStats::Timer step_timer;
+    int rc = sqlite3_step(stmt);
+    stats.record(ArchiveStats::STEP, step_timer);
+    return rc;
+}
+
+// Backoff before busy retry number attempt (0-based): exponential with
+// "equal jitter", so contending threads spread out but never spin
+static uint64_t busyDelayUs(int attempt) {
+    thread_local std::minstd_rand rng(static_cast<uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+        static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count())));
+    
+    uint64_t cap = attempt < 16 ? std::min<uint64_t>(BUSY_BACKOFF_MAX_US, uint64_t(BUSY_BACKOFF_MIN_US) << attempt)
+                                : BUSY_BACKOFF_MAX_US;
+    return cap / 2 + rng() % (cap / 2 + 1);
+}
+
+// Longest total sleep before retry number attempt, ignoring jitter
+static uint64_t busyScheduleUs(int attempt) {
+    uint64_t total = 0;
+    for (int i = 0; i < attempt && total < std::numeric_limits<uint32_t>::max(); ++i) {
+        total += i < 16 ? std::min<uint64_t>(BUSY_BACKOFF_MAX_US, uint64_t(BUSY_BACKOFF_MIN_US) << i)
+                        : BUSY_BACKOFF_MAX_US;
+    }
+    return total;
+}
+
+int BookArchive::busyHandler(void* policy, int attempt) {
+    BusyPolicy* busy = static_cast<BusyPolicy*>(policy);
+    if (busyScheduleUs(attempt) >= static_cast<uint64_t>(busy->timeout_ms) * 1000) {
+        if (!busy->narrowed) {
+            busy->owner->stats.countBusyTimeout();
+        }
+        return 0;  // SQLITE_BUSY goes back to the caller
+    }
+    
+    uint64_t delay = busyDelayUs(attempt);
+    std::this_thread::sleep_for(std::chrono::microseconds(delay));
+    busy->owner->stats.countBusyWait(delay * 1000);
+    return 1;
+}
+
+bool BookArchive::beginImmediate(std::unique_lock<std::shared_mutex>& lock) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.busy_timeout);
+    
+    for (int attempt = 0;; ++attempt) {
+        // Only a short wait inside SQLite while db_mutex is held; longer ones happen below
+        writer_busy.timeout_ms = std::min(config.busy_timeout, BUSY_LOCKED_WAIT_MS);
+        writer_busy.narrowed = true;
+        char* errmsg = nullptr;
+        int rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, &errmsg);
+        writer_busy.timeout_ms = config.busy_timeout;
+        writer_busy.narrowed = false;
+        
+        if (rc == SQLITE_OK) {
+            return true;
+        }
+        if (rc != SQLITE_BUSY || std::chrono::steady_clock::now() >= deadline) {
+            if (rc == SQLITE_BUSY) {
+                stats.countBusyTimeout();
+            }
+            log(LogLevel::ERROR, "Failed to begin a write transaction: " + 
+                std::string(errmsg ? errmsg : sqlite3_errmsg(db)));
+            sqlite3_free(errmsg);
+            return false;
+        }
+        sqlite3_free(errmsg);
+        
+        // Another process holds the write lock: back off without blocking this one
+        uint64_t delay = busyDelayUs(attempt);
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(delay));
+        stats.countLockRetry(delay * 1000);
+        lock.lock();
+        
+        if (!sqlite3_get_autocommit(db)) {
+            return false;  // Someone opened a transaction meanwhile; the caller joins it
+        }
+    }
+}
+
+void BookArchive::startMaintenance() {
+    // WAL is only possible for files, and the other journal modes have nothing to checkpoint
+    if (db_filename.empty() || db_filename == ":memory:" || config.journal_mode != "WAL") {
+        return;
+    }
+    
+    // The hook replaces SQLite's autocheckpoint, which would run in the committing writer
+    std::string error;
+    auto report = [this](LogLevel level, const std::string& message) { log(level, message); };
+    if (!maintenance.start(db_filename, config.wal_autocheckpoint, report, error)) {
+        log(LogLevel::ERROR, error + ". The writer checkpoints the WAL itself.");
+        sqlite3_wal_autocheckpoint(db, config.wal_autocheckpoint);
+        return;
+    }
+    sqlite3_wal_hook(db, &ArchiveMaintenance::walHook, &maintenance);
+}
+
+StatsSnapshot BookArchive::statsSnapshot() const {
+    StatsSnapshot snapshot;
+    stats.snapshot(snapshot);
+    snapshot.writer_statements = stmt_cache.counters();
+    snapshot.reader_statements = read_pool.statementCounters();
+    snapshot.books = book_cache.counters();
+    snapshot.searches = search_cache.counters();
+    snapshot.maintenance = maintenance.counters();
+    snapshot.suggestions = suggest_index.counters();
+    snapshot.async_reads = query_executor.counters();
+    snapshot.log_dropped = logger.dropped();
+    return snapshot;
+}
+
+void BookArchive::resetStats() {
+    stats.reset();
+    log(LogLevel::INFO, "Statistics reset");
+}
+
+bool BookArchive::executeRawSQL(const char* sql) {
+    char* errmsg = nullptr;
+    int rc = sqlite3_exec(db, sql, nullptr, nullptr, &errmsg);
+    if (rc != SQLITE_OK) {
+        log(LogLevel::ERROR, "Failed to execute '" + std::string(sql) + "': " + 
+            std::string(errmsg ? errmsg : sqlite3_errmsg(db)));
+        sqlite3_free(errmsg);
+        return false;
+    }
+    return true;
+}
+
+bool BookArchive::beginBulkLoad() {
+    if (!config.bulk_imports) {
+        return false;
+    }
+    
+    std::lock_guard<std::shared_mutex> lock(db_mutex);
+    
+    // SQLite cannot change the synchronous level inside a transaction (batch --group)
+    if (!sqlite3_get_autocommit(db)) {
+        log(LogLevel::DEBUG, "Transaction open, keeping the configured settings for this import");
+        return false;
+    }
+    
+    for (const std::string& pragma : DatabaseConfig::bulkLoadPragmas()) {
+        executeRawSQL(pragma.c_str());
+    }
+    maintenance.setCheckpointPages(DatabaseConfig::bulkLoadProfile().wal_autocheckpoint);
+    log(LogLevel::INFO, "Switched to the bulk-load settings for an import");
+    return true;
+}
+
+void BookArchive::endBulkLoad(bool active) {
+    if (!active) {
+        return;
+    }
+    
+    std::lock_guard<std::shared_mutex> lock(db_mutex);
+    for (const std::string& pragma : config.restorePragmas()) {
+        executeRawSQL(pragma.c_str());
+    }
+    maintenance.setCheckpointPages(config.wal_autocheckpoint);
+    log(LogLevel::INFO, "Restored the " + config.profile + " settings after an import");
+}
+
+size_t BookArchive::insertBookBatch(sqlite3_stmt* stmt, const Book* books, size_t count, size_t& failed) {
+    std::unique_lock<std::shared_mutex> lock(db_mutex);
+    
+    if (!beginImmediate(lock)) {
+        failed += count;
+        return 0;
+    }
+    
+    size_t inserted = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Book& book = books[i];
+        sqlite3_reset(stmt);
+        
+        // The book outlives the step, so SQLite does not need its own copy.
+        // A successful insert needs no cache invalidation: only existing rows are cached.
+        if (sqlbind::bindAll(stmt, book.id, book.title, book.author) == SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_DONE) {
+            inserted++;
+        } else {
+            failed++;
+            log(LogLevel::ERROR, "Failed to import book ID=" + std::to_string(book.id) + 
+                ": " + std::string(sqlite3_errmsg(db)));
+        }
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    if (!executeRawSQL("COMMIT;")) {
+        executeRawSQL("ROLLBACK;");
+        failed += inserted;
+        return 0;
+    }
+    search_cache.invalidate();
+    return inserted;
+}
+
+size_t BookArchive::addBooks(const std::vector<Book>& books, size_t batch_size) {
+    if (rejectWrite("add the books")) {
+        return 0;
+    }
+    
+    log(LogLevel::INFO, "Bulk adding " + std::to_string(books.size()) + 
+        " books in batches of " + std::to_string(batch_size));
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    StatementCache::Lease stmt = getPreparedStatement(INSERT_BOOK_SQL);
+    if (!stmt) {
+        console() << "Error: Failed to add the books. Check logs for details." << std::endl;
+        return 0;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    bool bulk = beginBulkLoad();
+    size_t inserted = 0;
+    size_t failed = 0;
+    
+    for (size_t offset = 0; offset < books.size(); offset += batch_size) {
+        size_t count = std::min(batch_size, books.size() - offset);
+        inserted += insertBookBatch(stmt.get(), books.data() + offset, count, failed);
+    }
+    
+    endBulkLoad(bulk);
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Bulk add finished: " + std::to_string(inserted) + " inserted, " + 
+        std::to_string(failed) + " failed");
+    console() << "Added " << inserted << " book(s), " << failed << " failed, " 
+              << formatThroughput(inserted, seconds) << std::endl;
+    
+    return inserted;
+}
+
+size_t BookArchive::importBooks(const std::string& filename, size_t batch_size) {
+    if (rejectWrite("import books")) {
+        return 0;
+    }
+    
+    log(LogLevel::INFO, "Importing books from file: '" + filename + "'");
+    
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        log(LogLevel::ERROR, "Cannot open import file: " + filename);
+        console() << "Error: Cannot open file '" << filename << "'." << std::endl;
+        return 0;
+    }
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    StatementCache::Lease stmt = getPreparedStatement(INSERT_BOOK_SQL);
+    if (!stmt) {
+        console() << "Error: Failed to import the books. Check logs for details." << std::endl;
+        return 0;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    bool bulk = beginBulkLoad();
+    size_t inserted = 0;
+    size_t failed = 0;
+    size_t lineNo = 0;
+    
+    // Only one batch is held in memory, so arbitrarily large dumps can be streamed
+    std::vector<Book> batch;
+    batch.reserve(batch_size);
+    std::vector<std::string> fields;
+    std::string line;
+    
+    while (std::getline(file, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        if (!parseCsvLine(line, fields) || fields.size() != 3) {
+            log(LogLevel::ERROR, "Malformed import line " + std::to_string(lineNo) + ": " + line);
+            failed++;
+            continue;
+        }
+        
+        char* end = nullptr;
+        long id = std::strtol(fields[0].c_str(), &end, 10);
+        if (fields[0].empty() || *end != '\0') {
+            // Tolerate a header row in the first line
+            if (lineNo != 1) {
+                log(LogLevel::ERROR, "Invalid book ID on import line " + std::to_string(lineNo) + ": " + fields[0]);
+                failed++;
+            }
+            continue;
+        }
+        
+        if (fields[1].empty() || fields[2].empty()) {
+            log(LogLevel::ERROR, "Empty title or author on import line " + std::to_string(lineNo));
+            failed++;
+            continue;
+        }
+        
+        batch.push_back(Book{static_cast<int>(id), std::move(fields[1]), std::move(fields[2])});
+        if (batch.size() == batch_size) {
+            inserted += insertBookBatch(stmt.get(), batch.data(), batch.size(), failed);
+            batch.clear();
+        }
+    }
+    
+    if (!batch.empty()) {
+        inserted += insertBookBatch(stmt.get(), batch.data(), batch.size(), failed);
+    }
+    
+    endBulkLoad(bulk);
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Import finished: " + std::to_string(inserted) + " inserted, " + 
+        std::to_string(failed) + " failed");
+    console() << "Imported " << inserted << " book(s), " << failed << " failed, " 
+              << formatThroughput(inserted, seconds) << std::endl;
+    
+    return inserted;
+}
+
+bool BookArchive::writeChunk(const std::function<bool()>& work) {
+    std::unique_lock<std::shared_mutex> lock(db_mutex);
+    if (!beginImmediate(lock)) {
+        return false;
+    }
+    
+    if (!work() || !executeRawSQL("COMMIT;")) {
+        // Some errors have already rolled the transaction back
+        if (!sqlite3_get_autocommit(db)) {
+            executeRawSQL("ROLLBACK;");
+        }
+        return false;
+    }
+    search_cache.invalidate();
+    return true;
+}
+
+size_t BookArchive::deleteBooks(const std::vector<int>& ids, size_t batch_size) {
+    if (rejectWrite("delete the books")) {
+        return 0;
+    }
+    
+    log(LogLevel::INFO, "Bulk deleting " + std::to_string(ids.size()) + 
+        " books in batches of " + std::to_string(batch_size));
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::string idArray;
+    size_t deleted = 0;
+    size_t failed = 0;
+    
+    // One DELETE per chunk, the ids bound as a JSON array
+    for (size_t offset = 0; offset < ids.size(); offset += batch_size) {
+        size_t count = std::min(batch_size, ids.size() - offset);
+        appendIdArray(idArray, ids.data() + offset, count);
+        
+        size_t changed = 0;
+        bool ok = writeChunk([&] {
+            if (!execute(DELETE_BOOKS_SQL, idArray)) {
+                return false;
+            }
+            changed = static_cast<size_t>(sqlite3_changes(db));
+            return true;
+        });
+        
+        if (ok) {
+            deleted += changed;
+            for (size_t i = offset; i < offset + count; ++i) {
+                book_cache.invalidate(ids[i]);
+            }
+        } else {
+            failed += count;
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Bulk delete finished: " + std::to_string(deleted) + " deleted, " + 
+        std::to_string(failed) + " failed");
+    if (deleted > 0) {
+        compactChanges();
+    }
+    if (failed > 0) {
+        console() << "Error: Failed to delete " << failed << " of the books. Check logs for details." << std::endl;
+    }
+    console() << "Deleted " << deleted << " book(s) " << formatThroughput(deleted, seconds) << std::endl;
+    
+    return deleted;
+}
+
+size_t BookArchive::deleteRange(int lo, int hi, size_t batch_size) {
+    if (rejectWrite("delete the books")) {
+        return 0;
+    }
+    
+    log(LogLevel::INFO, "Deleting books with IDs " + std::to_string(lo) + " to " + std::to_string(hi));
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    size_t deleted = 0;
+    bool failed = false;
+    bool cutShort = false;
+    int next = lo;
+    
+    // Walk the range in chunks of batch_size existing ids, each its own transaction,
+    // so a huge range never holds the write lock (or grows the WAL) in one go
+    while (next <= hi) {
+        int end = hi;
+        size_t changed = 0;
+        bool ok = writeChunk([&] {
+            std::optional<sqlite3_int64> chunkEnd = queryInt(RANGE_CHUNK_END_SQL, next, hi, 
+                                                             static_cast<sqlite3_int64>(batch_size - 1));
+            if (chunkEnd) {
+                end = static_cast<int>(*chunkEnd);
+            }
+            if (!execute(DELETE_RANGE_SQL, next, end)) {
+                return false;
+            }
+            changed = static_cast<size_t>(sqlite3_changes(db));
+            return true;
+        });
+        
+        if (!ok) {
+            failed = true;
+            break;
+        }
+        deleted += changed;
+        if (end == hi) {
+            break;
+        }
+        next = end + 1;
+        if (!running) {
+            cutShort = true;  // Interrupted: the chunks deleted so far stay deleted
+            break;
+        }
+    }
+    
+    // Cached books in the range are not tracked individually
+    if (deleted > 0) {
+        book_cache.clear();
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Range delete finished: " + std::to_string(deleted) + " deleted" +
+        (failed ? ", stopped by an error" : ""));
+    if (deleted > 0) {
+        compactChanges();
+    }
+    if (failed || cutShort) {
+        console() << "Error: Stopped before ID " << next << ", the books before it were deleted. "
+                  << "Check logs for details." << std::endl;
+    }
+    console() << "Deleted " << deleted << " book(s) " << formatThroughput(deleted, seconds) << std::endl;
+    
+    return deleted;
+}
+
+size_t BookArchive::updateBooks(const std::vector<Book>& books, size_t batch_size) {
+    if (rejectWrite("update the books")) {
+        return 0;
+    }
+    
+    log(LogLevel::INFO, "Bulk updating " + std::to_string(books.size()) + 
+        " books in batches of " + std::to_string(batch_size));
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> ids;
+    std::string idArray;
+    size_t updated = 0;
+    size_t failed = 0;
+    
+    for (size_t offset = 0; offset < books.size(); offset += batch_size) {
+        size_t count = std::min(batch_size, books.size() - offset);
+        ids.clear();
+        for (size_t i = offset; i < offset + count; ++i) {
+            ids.push_back(books[i].id);
+        }
+        appendIdArray(idArray, ids.data(), ids.size());
+        
+        size_t matched = 0;
+        bool ok = writeChunk([&] {
+            // Updates through the view match no row for a missing id without
+            // saying so, so count the existing ones up front
+            std::optional<sqlite3_int64> existing = queryInt(COUNT_BOOKS_SQL, idArray);
+            if (!existing) {
+                return false;
+            }
+            matched = static_cast<size_t>(*existing);
+            
+            for (size_t i = offset; i < offset + count; ++i) {
+                const Book& book = books[i];
+                if (!execute(UPDATE_BOOK_SQL, book.title, book.author.str(), book.id)) {
+                    log(LogLevel::ERROR, "Failed to update book ID=" + std::to_string(book.id));
+                    return false;
+                }
+            }
+            return true;
+        });
+        
+        if (ok) {
+            updated += matched;
+            for (int id : ids) {
+                book_cache.invalidate(id);
+            }
+        } else {
+            failed += count;
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Bulk update finished: " + std::to_string(updated) + " updated, " + 
+        std::to_string(failed) + " failed");
+    if (failed > 0) {
+        console() << "Error: Failed to update " << failed << " of the books. Check logs for details." << std::endl;
+    }
+    console() << "Updated " << updated << " book(s) " << formatThroughput(updated, seconds) << std::endl;
+    
+    return updated;
+}
+
+const char* BookChange::opName() const {
+    switch (op) {
+        case Op::INSERT: return "insert";
+        case Op::UPDATE: return "update";
+        case Op::DELETE: return "delete";
+    }
+    return "";
+}
+
+ChangeFeed BookArchive::changesSince(int64_t seq, size_t limit) {
+    ChangeFeed feed;
+    feed.next_seq = seq;
+    if (snapshot_mode) {
+        return feed;  // A snapshot never changes
+    }
+    
+    // One row more than asked for tells whether another page follows
+    sqlite3_int64 probe = limit > 0 ? static_cast<sqlite3_int64>(limit) + 1 : -1;
+    Cursor rows = cursor(CHANGES_SINCE_SQL, static_cast<sqlite3_int64>(seq), probe);
+    for (const BookView& row : rows) {
+        if (limit > 0 && feed.changes.size() == limit) {
+            feed.more = true;
+            break;
+        }
+        
+        std::string_view op = rows.columnText(4);
+        BookChange change;
+        change.seq = rows.columnInt(3);
+        change.op = op == "delete" ? BookChange::Op::DELETE : 
+                    op == "update" ? BookChange::Op::UPDATE : BookChange::Op::INSERT;
+        change.book = row.toBook();
+        feed.next_seq = change.seq;
+        feed.changes.push_back(std::move(change));
+    }
+    rows.finish();
+    
+    // Read after the changes: a purge in between can only cause a needless
+    // resync, never a silently missed deletion
+    if (seq > 0) {
+        Cursor state = cursor(PURGED_SEQ_SQL);
+        if (state.next() && state.columnInt(0) > seq) {
+            feed.resync = true;
+        }
+    }
+    return feed;
+}
+
+size_t BookArchive::compactChanges() {
+    if (!writable()) {
+        return 0;
+    }
+    
+    // Usually there is nothing to drop; finding that out needs no write lock
+    std::string age = "-" + std::to_string(CHANGE_TOMBSTONE_DAYS) + " days";
+    {
+        std::lock_guard<std::shared_mutex> lock(db_mutex);
+        if (queryInt(PURGEABLE_CHANGES_SQL, age).value_or(1) == 0) {
+            return 0;
+        }
+    }
+    
+    size_t purged = 0;
+    bool ok = writeChunk([&] {
+        // Raise the horizon in the same transaction as the purge
+        if (!execute(MARK_PURGED_SQL, age) || !execute(PURGE_CHANGES_SQL, age)) {
+            return false;
+        }
+        purged = static_cast<size_t>(sqlite3_changes(db));
+        return true;
+    });
+    
+    if (!ok) {
+        log(LogLevel::ERROR, "Failed to compact the change log");
+        return 0;
+    }
+    if (purged > 0) {
+        log(LogLevel::INFO, "Compacted the change log: dropped " + std::to_string(purged) + " old deletion(s)");
+    }
+    return purged;
+}
+
+void BookArchive::suggestChange(sqlite3_context* context, int, sqlite3_value** argv) {
+    auto* self = static_cast<BookArchive*>(sqlite3_user_data(context));
+    sqlite3_result_null(context);
+    if (!self->suggest_ready.load(std::memory_order_relaxed)) {
+        return;  // Not built yet; the build reads the table as it is by then
+    }
+    
+    auto value = [&](int index) -> std::optional<std::string_view> {
+        if (sqlite3_value_type(argv[index]) == SQLITE_NULL) {
+            return std::nullopt;
+        }
+        const char* text = reinterpret_cast<const char*>(sqlite3_value_text(argv[index]));
+        return std::string_view(text ? text : "", static_cast<size_t>(sqlite3_value_bytes(argv[index])));
+    };
+    
+    // Arguments: old title, old author, new title, new author (NULL when there is none)
+    for (int field = 0; field < 2; ++field) {
+        std::optional<std::string_view> before = value(field);
+        std::optional<std::string_view> after = value(field + 2);
+        if (before && after && *before == *after) {
+            continue;
+        }
+        SuggestIndex::Kind kind = field == 0 ? SuggestIndex::Kind::TITLE : SuggestIndex::Kind::AUTHOR;
+        if (before) {
+            self->suggest_staged.push_back(SuggestIndex::Change{std::string(*before), kind, false});
+        }
+        if (after) {
+            self->suggest_staged.push_back(SuggestIndex::Change{std::string(*after), kind, true});
+        }
+    }
+}
+
+int BookArchive::suggestCommit(void* archive) {
+    auto* self = static_cast<BookArchive*>(archive);
+    self->suggest_index.apply(self->suggest_staged);
+    self->suggest_uncommitted = false;
+    return 0;  // Never turns the commit into a rollback
+}
+
+void BookArchive::suggestRollback(void* archive) {
+    auto* self = static_cast<BookArchive*>(archive);
+    self->suggest_staged.clear();
+    
+    // Built from rows that are gone now: build again on the next suggest
+    if (self->suggest_uncommitted) {
+        self->suggest_uncommitted = false;
+        self->suggest_ready = false;
+    }
+}
+
+void BookArchive::buildSuggestIndex() {
+    std::lock_guard<std::mutex> build_lock(suggest_build_mutex);
+    if (suggest_ready.load()) {
+        return;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    SuggestIndex::Builder builder;
+    size_t books = 0;
+    
+    if (snapshot_mode) {
+        for (; books < snapshot.size(); ++books) {
+            BookView book = snapshot.at(books);
+            builder.add(book.title, book.author);
+        }
+        suggest_index.replace(builder);
+        suggest_ready = true;
+    } else {
+        // Writers wait for the scan, so no commit falls between it and the first staged change
+        std::lock_guard<std::shared_mutex> lock(db_mutex);
+        sqlite3_stmt* stmt = nullptr;
+        int rc = sqlite3_prepare_v2(db, "SELECT title, author FROM book_rows;", -1, &stmt, nullptr);
+        while (rc == SQLITE_OK || rc == SQLITE_ROW) {
+            if ((rc = sqlite3_step(stmt)) != SQLITE_ROW) {
+                break;
+            }
+            const char* title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            const char* author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            builder.add(std::string_view(title ? title : "", sqlite3_column_bytes(stmt, 0)),
+                        std::string_view(author ? author : "", sqlite3_column_bytes(stmt, 1)));
+            books++;
+        }
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            log(LogLevel::ERROR, "Failed to build the suggest index: " + std::string(sqlite3_errmsg(db)));
+            return;
+        }
+        
+        suggest_index.replace(builder);
+        suggest_uncommitted = !sqlite3_get_autocommit(db);
+        suggest_staged.clear();
+        suggest_ready = true;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    log(LogLevel::INFO, "Built the suggest index from " + std::to_string(books) + " book(s) in " + 
+        std::to_string(static_cast<int>(seconds * 1000)) + " ms");
+}
+
+std::vector<SuggestIndex::Suggestion> BookArchive::suggest(std::string_view prefix, size_t limit) {
+    if (!suggest_ready.load(std::memory_order_acquire)) {
+        buildSuggestIndex();
+    }
+    return suggest_index.suggest(prefix, limit == 0 ? SUGGEST_MAX_LIMIT : std::min<size_t>(limit, SUGGEST_MAX_LIMIT));
+}
+
+BookArchive::Cursor BookArchive::streamSearch(const std::string& keyword, const PageOptions& page) {
+    if (snapshot_mode) {
+        return snapshotCursor(page, keyword);
+    }
+    
+    std::string matchQuery = fts_enabled ? buildMatchQuery(keyword) : "";
+    
+    if (!matchQuery.empty()) {
+        if (!page.paged()) {
+            // Ranked full-text lookup, bm25 puts the best matches first
+            static const std::string sql = 
+                "SELECT b.id, b.title, b.author FROM books_fts "
+                "JOIN book_rows b ON b.id = books_fts.rowid "
+                "WHERE books_fts MATCH ? ORDER BY rank;";
+            return cursor(sql, matchQuery);
+        }
+        
+        static const std::string sql = 
+            "SELECT b.id, b.title, b.author FROM books_fts "
+            "JOIN book_rows b ON b.id = books_fts.rowid "
+            "WHERE books_fts MATCH ? AND books_fts.rowid > ? ORDER BY books_fts.rowid LIMIT ?;";
+        return cursor(sql, matchQuery, pageLowerBound(page), pageLimit(page));
+    }
+    
+    // % and _ have always been LIKE wildcards here, so keep LIKE for keywords using them
+    if (keyword.find_first_of("%_") != std::string::npos) {
+        static const std::string sql = 
+            "SELECT id, title, author FROM book_rows WHERE (title LIKE ?1 OR author LIKE ?1) "
+            "AND id > ?2 ORDER BY id LIMIT ?3;";
+        return cursor(sql, "%" + keyword + "%", pageLowerBound(page), pageLimit(page));
+    }
+    
+    // A plain substring: the same matches as LIKE '%keyword%', without its byte-at-a-time matcher
+    static const std::string sql = 
+        "SELECT id, title, author FROM book_rows "
+        "WHERE (contains_text(title, ?1) OR contains_text(author, ?1)) AND id > ?2 ORDER BY id LIMIT ?3;";
+    return cursor(sql, keyword, pageLowerBound(page), pageLimit(page));
+}
+
+BookArchive::Cursor BookArchive::snapshotCursor(const PageOptions& page, std::string_view keyword, bool exact_author) {
+    stats.countQuery();
+    
+    // Snapshot records are in id order, so paged and unpaged searches are both id ordered
+    Cursor cursor;
+    cursor.owner = this;
+    cursor.source = &snapshot;
+    cursor.source_index = page.after_id ? snapshot.upperBound(*page.after_id) : 0;
+    cursor.source_end = snapshot.size();
+    cursor.source_remaining = page.limit > 0 ? page.limit : std::numeric_limits<size_t>::max();
+    cursor.source_exact = exact_author;
+    if (exact_author) {
+        cursor.source_author.assign(keyword);
+    } else {
+        cursor.source_scan = TextScan(keyword);
+    }
+    return cursor;
+}
+
+BookArchive::Cursor BookArchive::streamBooksByAuthor(const std::string& author, const PageOptions& page) {
+    if (snapshot_mode) {
+        return snapshotCursor(page, author, true);
+    }
+    
+    // One probe of the unique name index, then a range of idx_books_author_id,
+    // which is ordered by book id within each author
+    static const std::string sql = 
+        "SELECT b.id, b.title, a.name FROM authors a "
+        "JOIN books b ON b.author_id = a.id "
+        "WHERE a.name = ? AND b.id > ? ORDER BY b.id LIMIT ?;";
+    return cursor(sql, author, pageLowerBound(page), pageLimit(page));
+}
+
+BookArchive::Cursor BookArchive::streamBooks(const PageOptions& page) {
+    if (snapshot_mode) {
+        return snapshotCursor(page, {});
+    }
+    
+    // Seeks straight to after_id on the primary key, so deep pages cost the same as the first
+    static const std::string sql = "SELECT id, title, author FROM book_rows WHERE id > ? ORDER BY id LIMIT ?;";
+    return cursor(sql, pageLowerBound(page), pageLimit(page));
+}
+
+void BookArchive::searchPartition(const std::vector<std::string>& keywords, size_t first, size_t stride,
+                                  BookResults& found) {
+    // All FTS terms go into one OR query; the rest are matched in a single scan
+    std::string matchQuery;
+    std::vector<TextScan> scanTerms;
+    for (size_t i = first; i < keywords.size(); i += stride) {
+        std::string terms = fts_enabled ? buildMatchQuery(keywords[i]) : "";
+        if (!terms.empty()) {
+            matchQuery += matchQuery.empty() ? "(" : " OR (";
+            matchQuery += terms + ")";
+            continue;
+        }
+        scanTerms.emplace_back(keywords[i]);
+    }
+    
+    if (!matchQuery.empty()) {
+        static const std::string sql = 
+            "SELECT b.id, b.title, b.author FROM books_fts "
+            "JOIN book_rows b ON b.id = books_fts.rowid "
+            "WHERE books_fts MATCH ? ORDER BY books_fts.rowid;";
+        Cursor rows = cursor(sql, matchQuery);
+        for (const BookView& book : rows) {
+            found.add(book);
+        }
+    }
+    
+    if (!scanTerms.empty()) {
+        // Case-insensitive substring matching, one pass for every keyword
+        Cursor rows = streamBooks();
+        for (const BookView& book : rows) {
+            for (const TextScan& term : scanTerms) {
+                if (term.matches(book.title) || term.matches(book.author)) {
+                    found.add(book);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+BookResults BookArchive::searchBooks(const std::vector<std::string>& keywords) {
+    std::vector<std::string> distinct;
+    for (const std::string& keyword : keywords) {
+        std::string_view trimmed = CommandTokenizer::trim(keyword);
+        if (!trimmed.empty()) {
+            distinct.emplace_back(trimmed);
+        }
+    }
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    if (distinct.empty()) {
+        return {};
+    }
+    
+    if (snapshot_mode) {
+        return searchSnapshot(distinct);
+    }
+    
+    // One partition per read connection, so no worker waits for a lease. Without
+    // readers every query would take the writer lock, so there is nothing to gain.
+    size_t workers = read_pool_size;
+    size_t partitions = std::max<size_t>(1, std::min(workers, distinct.size()));
+    
+    log(LogLevel::INFO, "Searching for " + std::to_string(distinct.size()) + " keyword(s) in " + 
+        std::to_string(partitions) + " partition(s)");
+    
+    std::vector<BookResults> found(partitions);
+    auto run = [&](size_t partition) {
+        try {
+            searchPartition(distinct, partition, partitions, found[partition]);
+        } catch (const std::exception& e) {
+            log(LogLevel::ERROR, "Keyword search failed: " + std::string(e.what()));
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(partitions - 1);
+    for (size_t partition = 1; partition < partitions; ++partition) {
+        threads.emplace_back(run, partition);
+    }
+    run(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    // Concatenate the partitions, keeping their arenas, then sort and drop
+    // books several keywords found
+    BookResults merged;
+    size_t total = 0;
+    for (const BookResults& part : found) {
+        total += part.size();
+    }
+    merged.reserve(total);
+    for (BookResults& part : found) {
+        merged.append(std::move(part));
+    }
+    merged.sortById();
+    return merged;
+}
+
+BookResults BookArchive::searchSnapshot(const std::vector<std::string>& keywords) {
+    stats.countQuery();
+    std::vector<TextScan> scans(keywords.begin(), keywords.end());
+    
+    size_t books = snapshot.size();
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::max<size_t>(1, std::min(cores, books / SNAPSHOT_SEARCH_CHUNK));
+    
+    log(LogLevel::INFO, "Searching the snapshot for " + std::to_string(keywords.size()) + " keyword(s) in " + 
+        std::to_string(chunks) + " chunk(s)");
+    
+    std::vector<BookResults> found(chunks);
+    auto run = [&](size_t chunk) {
+        try {
+            size_t end = books * (chunk + 1) / chunks;
+            for (size_t i = books * chunk / chunks; i < end; ++i) {
+                BookView book = snapshot.at(i);
+                for (const TextScan& scan : scans) {
+                    if (scan.matches(book.title) || scan.matches(book.author)) {
+                        found[chunk].add(book);
+                        break;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            log(LogLevel::ERROR, "Snapshot search failed: " + std::string(e.what()));
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        threads.emplace_back(run, chunk);
+    }
+    run(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    // Chunks are consecutive runs of ids, so concatenating them keeps the order
+    BookResults merged = std::move(found[0]);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        merged.append(std::move(found[chunk]));
+    }
+    return merged;
+}
+
+std::string BookArchive::searchCacheKey(const std::string& keyword, const PageOptions& page) const {
+    // Both kinds of search ignore ASCII case
+    std::string match = fts_enabled ? buildMatchQuery(keyword) : "";
+    std::string key = match.empty() ? "scan:" + keyword : "match:" + match;
+    for (char& c : key) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    
+    key += page.after_id ? "|after=" + std::to_string(*page.after_id) : "|first";
+    key += "|limit=" + std::to_string(page.limit);
+    return key;
+}
+
+BookResults BookArchive::searchBook(const std::string& keyword, const PageOptions& page) {
+    log(LogLevel::INFO, "Searching for books with keyword: '" + keyword + "'");
+    
+    std::string key = searchCacheKey(keyword, page);
+    BookResults books;
+    uint64_t token;
+    if (search_cache.get(key, books, token)) {
+        return books;
+    }
+    
+    if (snapshot_mode && !page.paged()) {
+        // Unpaged, every record is scanned: split them across the cores as search-many does
+        books = searchSnapshot({keyword});
+    } else {
+        books = collectBooks(streamSearch(keyword, page), page);
+    }
+    search_cache.put(key, books, token);
+    return books;
+}
+
+BookResults BookArchive::booksByAuthor(const std::string& author, const PageOptions& page) {
+    log(LogLevel::INFO, "Listing books by author: '" + author + "'");
+    return collectBooks(streamBooksByAuthor(author, page), page);
+}
+
+BookResults BookArchive::listBooks(const PageOptions& page) {
+    log(LogLevel::INFO, "Listing books");
+    return collectBooks(streamBooks(page), page);
+}
+
+size_t BookArchive::exportBooks(const std::string& filename) {
+    log(LogLevel::INFO, "Exporting books to file: '" + filename + "'");
+    
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file.is_open()) {
+        log(LogLevel::ERROR, "Cannot open export file: " + filename);
+        console() << "Error: Cannot open file '" << filename << "'." << std::endl;
+        return 0;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    // Same layout importBooks reads back
+    file << "id,title,author\n";
+    Cursor rows = streamBooks();
+    for (const BookView& book : rows) {
+        file << book.id << ',';
+        writeCsvField(file, book.title);
+        file << ',';
+        writeCsvField(file, book.author);
+        file << '\n';
+    }
+    file.flush();
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (rows.failed() || !file) {
+        log(LogLevel::ERROR, "Export to " + filename + " did not complete");
+        console() << "Error: Export incomplete after " << rows.rowCount() << " book(s). Check logs for details." << std::endl;
+        return rows.rowCount();
+    }
+    
+    console() << "Exported " << rows.rowCount() << " book(s) " << formatThroughput(rows.rowCount(), seconds) << std::endl;
+    return rows.rowCount();
+}
+
+size_t BookArchive::exportSnapshot(const std::string& filename) {
+    log(LogLevel::INFO, "Exporting snapshot to file: '" + filename + "'");
+    
+    auto start = std::chrono::steady_clock::now();
+    BookSnapshot::Writer writer(filename);
+    std::string error;
+    
+    Cursor rows = streamBooks();
+    for (const BookView& book : rows) {
+        if (!writer.add(book, error)) {
+            break;
+        }
+    }
+    if (error.empty() && rows.failed()) {
+        error = "Reading the archive failed";
+    }
+    if (error.empty()) {
+        writer.finish(error);
+    }
+    
+    if (!error.empty()) {
+        log(LogLevel::ERROR, "Snapshot export to " + filename + " failed: " + error);
+        console() << "Error: " << error << ". Snapshot not written." << std::endl;
+        return 0;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    console() << "Exported " << writer.size() << " book(s) to snapshot " 
+              << formatThroughput(writer.size(), seconds) << std::endl;
+    return writer.size();
+}
+
+size_t BookArchive::loadSnapshot(const std::string& filename, size_t batch_size) {
+    if (rejectWrite("load a snapshot")) {
+        return 0;
+    }
+    log(LogLevel::INFO, "Loading snapshot from file: '" + filename + "'");
+    
+    BookSnapshot source;
+    std::string error;
+    if (!source.open(filename, error)) {
+        log(LogLevel::ERROR, error);
+        console() << "Error: " << error << "." << std::endl;
+        return 0;
+    }
+    
+    if (batch_size == 0) {
+        batch_size = IMPORT_BATCH_SIZE;
+    }
+    
+    StatementCache::Lease stmt = getPreparedStatement(INSERT_BOOK_SQL);
+    if (!stmt) {
+        console() << "Error: Failed to load the snapshot. Check logs for details." << std::endl;
+        return 0;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    bool bulk = beginBulkLoad();
+    size_t inserted = 0;
+    size_t failed = 0;
+    
+    // Copies one batch at a time out of the mapping
+    std::vector<Book> batch;
+    batch.reserve(batch_size);
+    for (size_t i = 0; i < source.size(); ++i) {
+        batch.push_back(source.at(i).toBook());
+        if (batch.size() == batch_size) {
+            inserted += insertBookBatch(stmt.get(), batch.data(), batch.size(), failed);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        inserted += insertBookBatch(stmt.get(), batch.data(), batch.size(), failed);
+    }
+    
+    endBulkLoad(bulk);
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    log(LogLevel::INFO, "Snapshot load finished: " + std::to_string(inserted) + " inserted, " + 
+        std::to_string(failed) + " failed");
+    console() << "Loaded " << inserted << " book(s) from snapshot, " << failed << " failed, " 
+              << formatThroughput(inserted, seconds) << std::endl;
+    return inserted;
+}
+
+void BookArchive::help() {
+    console() << "\nBook Archive " << VERSION << " - Command List\n" << std::endl;
+    console() << "  add <id> <title>, <author>              - Add a new book" << std::endl;
+    console() << "  delete <id>                             - Delete a book by ID" << std::endl;
+    console() << "  delete-many <id>, <id>, ...             - Delete several books by ID" << std::endl;
+    console() << "  delete-many --file <file>               - The same, IDs read from a file" << std::endl;
+    console() << "  delete-range <first_id> <last_id>       - Delete every book with an ID in the range" << std::endl;
+    console() << "  update <id> <new_title>, <new_author>   - Update a book's information based on ID" << std::endl;
+    console() << "  get <id>                                - Show a single book by ID" << std::endl;
+    console() << "  search [--after <id>] [--limit N] <keyword>" << std::endl;
+    console() << "                                          - Search books by title or author" << std::endl;
+    console() << "  search-many <keyword>, <keyword>, ...   - Books matching any keyword, searched in parallel" << std::endl;
+    console() << "  search-many --file <file>               - The same, one keyword per line of a file" << std::endl;
+    console() << "  author [--after <id>] [--limit N] <name>" << std::endl;
+    console() << "                                          - List the books of one author (exact name)" << std::endl;
+    console() << "  import <file> [batch_size]              - Bulk import books from a CSV file (id,title,author)" << std::endl;
+    console() << "  export <file>                           - Export all books to a CSV file (id,title,author)" << std::endl;
+    console() << "  export-snapshot <file>                  - Write all books to a binary snapshot file" << std::endl;
+    console() << "  load-snapshot <file> [batch_size]       - Insert the books of a snapshot file" << std::endl;
+    console() << "  display [--after <id>] [--limit N]      - Show books in ID order, " << DISPLAY_PAGE_SIZE 
+              << " per page (--limit 0 for all)" << std::endl;
+    console() << "  get, search, search-many, author, display, changes and suggest also take --format table|tsv|json" << std::endl;
+    console() << "  changes [--limit N] [<seq>]             - Changes after seq, one per book, for incremental sync" << std::endl;
+    console() << "  suggest <prefix> [limit]                - Titles and authors starting with prefix, from memory" << std::endl;
+    console() << "  stats [reset]                           - Show (or reset) query latency and cache statistics" << std::endl;
+    console() << "  help                                    - Show this help menu" << std::endl;
+    console() << "  version                                 - Display the tool version" << std::endl;
+    console() << "  debug                                   - Toggle debug logging (if compiled with DEBUG_MODE)" << std::endl;
+    console() << "  exit                                    - Quit the program\n" << std::endl;
+}
+
+// One histogram as a row of the stats table, in microseconds
+static void printLatencyRow(const char* name, const LatencySummary& latency) {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    console() << "  " << std::left << std::setw(12) << name << std::right 
+              << std::setw(12) << latency.count
+              << std::setw(11) << us(latency.meanNs())
+              << std::setw(11) << us(latency.p50_ns)
+              << std::setw(11) << us(latency.p99_ns)
+              << std::setw(11) << us(latency.p999_ns)
+              << std::setw(11) << us(latency.max_ns) << std::endl;
+}
+
+void BookArchive::printStats() {
+    StatsSnapshot snapshot = statsSnapshot();
+    
+    if (snapshot.enabled) {
+        std::ios_base::fmtflags flags = console().flags();
+        std::streamsize precision = console().precision();
+        console() << std::fixed << std::setprecision(1);
+        
+        console() << "\nStatements: " << snapshot.executes << " executed, " << snapshot.queries 
+                  << " queries, " << snapshot.rows << " rows" << std::endl;
+        console() << "Group commit: " << snapshot.grouped_writes << " write(s) in " << snapshot.write_groups 
+                  << " transaction(s)" << std::endl;
+        console() << "Busy waits: " << snapshot.busy_waits << " (" << snapshot.busy_wait_ns / 1000000.0 
+                  << " ms), timeouts: " << snapshot.busy_timeouts << std::endl;
+        console() << "Write lock retries outside db_mutex: " << snapshot.lock_retries << " (" 
+                  << snapshot.lock_wait_ns / 1000000.0 << " ms)\n" << std::endl;
+        
+        console() << "  " << std::left << std::setw(12) << "Phase (us)" << std::right << std::setw(12) << "Count"
+                  << std::setw(11) << "Mean" << std::setw(11) << "p50" << std::setw(11) << "p99"
+                  << std::setw(11) << "p999" << std::setw(11) << "Max" << std::endl;
+        printLatencyRow("prepare", snapshot.prepare);
+        printLatencyRow("bind", snapshot.bind);
+        printLatencyRow("step", snapshot.step);
+        printLatencyRow("materialize", snapshot.materialize);
+        
+        console().flags(flags);
+        console().precision(precision);
+    } else {
+        console() << "\nLatency statistics are not compiled in (rebuild with ENABLE_STATS=1)." << std::endl;
+    }
+    
+    const StatementCache::Counters& w = snapshot.writer_statements;
+    const StatementCache::Counters& r = snapshot.reader_statements;
+    console() << "\nStatement cache (writer/readers): hits " << w.hits << "/" << r.hits << ", misses " 
+              << w.misses << "/" << r.misses << ", prepares " << w.prepares << "/" << r.prepares 
+              << ", evictions " << w.evictions << "/" << r.evictions << std::endl;
+    console() << "Book cache: " << snapshot.books.entries << " entries, hits " << snapshot.books.hits 
+              << ", misses " << snapshot.books.misses << ", evictions " << snapshot.books.evictions 
+              << ", invalidations " << snapshot.books.invalidations << std::endl;
+    const SearchCache::Counters& s = snapshot.searches;
+    console() << "Search cache: " << s.entries << " entries (" << s.bytes / 1024 << " KiB), hits " << s.hits
+              << ", misses " << s.misses << ", expired " << s.expirations << ", evictions " << s.evictions
+              << ", invalidations " << s.invalidations << ", writes seen " << s.generation << std::endl;
+    
+    const ArchiveMaintenance::Counters& m = snapshot.maintenance;
+    if (m.running) {
+        console() << "Checkpoints: " << m.passive_checkpoints << " passive, " << m.restart_checkpoints 
+                  << " restarting, " << m.truncate_checkpoints << " truncating, " << m.incomplete_checkpoints 
+                  << " incomplete, " << m.pages_checkpointed << " pages in " << m.checkpoint_ns / 1000000 << " ms" << std::endl;
+        console() << "WAL pages: " << m.wal_pages << " now, " << m.max_wal_pages << " peak; ANALYZE runs: " 
+                  << m.analyze_runs << " (" << m.analyze_ns / 1000000 << " ms)" << std::endl;
+    } else {
+        console() << "Background checkpoints: off" << std::endl;
+    }
+    
+    const SuggestIndex::Counters& t = snapshot.suggestions;
+    console() << "Suggest index: " << t.entries << " entries (" << t.delta << " unmerged), " << t.bytes / 1024 
+              << " KiB, lookups " << t.lookups << ", merges " << t.merges << std::endl;
+    const QueryExecutor::Counters& q = snapshot.async_reads;
+    console() << "Async reads: " << q.completed << " completed, " << q.queued << " queued, " << q.threads 
+              << " worker(s)" << std::endl;
+    console() << "Log records dropped: " << snapshot.log_dropped << "\n" << std::endl;
+}
+
+void BookArchive::version() {
+    console() << "Book Archive Version: " << VERSION << std::endl;
+    console() << "Build date: " << __DATE__ << " " << __TIME__ << std::endl;
+    console() << "SQLite version: " << sqlite3_libversion() << std::endl;
+    console() << "Substring scan: " << TextScan::kernelName() << std::endl;
+    if (snapshot_mode) {
+        console() << "Serving snapshot: " << db_filename << " (" << snapshot.size() << " books, read-only)" << std::endl;
+    } else {
+        printDatabaseSettings();
+    }
+    
+    #ifdef DEBUG_MODE
+    console() << "Build type: Debug" << std::endl;
+    #else
+    console() << "Build type: Release" << std::endl;
+    #endif
+}
+
+void BookArchive::printDatabaseSettings() {
+    static const char* const settings[] = {
+        "journal_mode", "synchronous", "cache_size", "mmap_size", "busy_timeout", "page_size", "wal_autocheckpoint",
+        "user_version"
+    };
+    static const char* const sync_levels[] = {"OFF", "NORMAL", "FULL", "EXTRA"};
+    
+    console() << "Database: " << db_filename << ", profile " << config.profile 
+              << (config.customized ? " (customized)" : "") 
+              << (config.bulk_imports ? ", bulk-load imports" : "") 
+              << (config.read_only ? ", read-only" : "") << std::endl;
+    
+    // Ask SQLite rather than echoing the config: some values are clamped or fixed by the file
+    std::lock_guard<std::shared_mutex> lock(db_mutex);
+    for (const char* name : settings) {
+        std::string sql = std::string("PRAGMA ") + name + ";";
+        sqlite3_stmt* stmt = nullptr;
+        std::string value = "?";
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK && 
+            sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            value = text ? text : "";
+            int level = sqlite3_column_int(stmt, 0);
+            if (std::string(name) == "synchronous" && level >= 0 && level < 4) {
+                value = sync_levels[level];
+            }
+        }
+        if (std::string(name) == "busy_timeout") {
+            value = std::to_string(config.busy_timeout) + " (busy handler)";
+        }
+        if (std::string(name) == "wal_autocheckpoint" && maintenance.counters().running) {
+            value = std::to_string(config.wal_autocheckpoint) + " (background checkpoints)";
+        }
+        sqlite3_finalize(stmt);
+        console() << "  " << std::left << std::setw(20) << name << std::right << value << std::endl;
+    }
+}
+
+void BookArchive::setOutputFormat(OutputFormat format) {
+    output_format = format;
+}
+
+void BookArchive::setLogLevel(LogLevel level) {
+    current_log_level = level;
+    log(LogLevel::INFO, "Log level set to: " + logLevelToString(level));
+}
+
+void BookArchive::executeCommand(const std::string& command, std::ostream& out) {
+    std::ostream* previous = command_output;
+    command_output = &out;
+    try {
+        processCommand(command);
+    } catch (...) {
+        command_output = previous;
+        throw;
+    }
+    command_output = previous;
+}
+
+// Parse the next token as a book id
+static bool parseId(CommandTokenizer& args, int& id, std::string& error) {
+    std::string_view token = args.next();
+    if (token.empty()) {
+        error = "Missing book ID";
+        return false;
+    }
+    if (!CommandTokenizer::parseNumber(token, id)) {
+        error = "Invalid book ID: " + std::string(token);
+        return false;
+    }
+    return true;
+}
+
+// Split the rest of the line at the first comma into a trimmed title and author
+static bool parseTitleAuthor(CommandTokenizer& args, std::string_view& title, std::string_view& author,
+                             const char* usage, std::string& error) {
+    std::string_view remainder = args.rest();
+    size_t commaPos = remainder.find(',');
+    if (commaPos == std::string_view::npos) {
+        error = usage;
+        return false;
+    }
+    
+    title = CommandTokenizer::trim(remainder.substr(0, commaPos));
+    author = CommandTokenizer::trim(remainder.substr(commaPos + 1));
+    if (title.empty() || author.empty()) {
+        error = "Title and author cannot be empty";
+        return false;
+    }
+    return true;
+}
+
+const BookArchive::CommandEntry BookArchive::command_table[] = {
+    {"add", &BookArchive::commandAdd},
+    {"delete", &BookArchive::commandDelete},
+    {"delete-many", &BookArchive::commandDeleteMany},
+    {"delete-range", &BookArchive::commandDeleteRange},
+    {"changes", &BookArchive::commandChanges},
+    {"suggest", &BookArchive::commandSuggest},
+    {"update", &BookArchive::commandUpdate},
+    {"get", &BookArchive::commandGet},
+    {"search", &BookArchive::commandSearch},
+    {"search-many", &BookArchive::commandSearchMany},
+    {"author", &BookArchive::commandAuthor},
+    {"import", &BookArchive::commandImport},
+    {"export", &BookArchive::commandExport},
+    {"export-snapshot", &BookArchive::commandExportSnapshot},
+    {"load-snapshot", &BookArchive::commandLoadSnapshot},
+    {"display", &BookArchive::commandDisplay},
+    {"stats", &BookArchive::commandStats},
+    {"help", &BookArchive::commandHelp},
+    {"version", &BookArchive::commandVersion},
+    {"debug", &BookArchive::commandDebug},
+    {"exit", &BookArchive::commandExit},
+};
+
+void BookArchive::processCommand(std::string_view command) {
+    CommandTokenizer args(command);
+    std::string_view action = args.next();
+    
+    try {
+        for (const CommandEntry& entry : command_table) {
+            if (entry.name != action) {
+                continue;
+            }
+            std::string error;
+            if (!(this->*entry.handler)(args, error)) {
+                reportCommandError(command, error);
+            }
+            return;
+        }
+        console() << "Invalid command. Type 'help' for a list of commands." << std::endl;
+    } catch (const std::exception& e) {
+        reportCommandError(command, e.what());
+    }
+}
+
+void BookArchive::reportCommandError(std::string_view command, const std::string& error) {
+    console() << "Error: " << error << std::endl;
+    log(LogLevel::ERROR, "Command error: " + error + " (Command: " + std::string(command) + ")");
+}
+
+bool BookArchive::commandAdd(CommandTokenizer& args, std::string& error) {
+    int id;
+    std::string_view title, author;
+    if (!parseId(args, id, error) || 
+        !parseTitleAuthor(args, title, author, "Invalid format. Use: add <id> <title>, <author>", error)) {
+        return false;
+    }
+    
+    addBook(id, title, author);
+    return true;
+}
+
+bool BookArchive::commandDelete(CommandTokenizer& args, std::string& error) {
+    int id;
+    if (!parseId(args, id, error)) {
+        return false;
+    }
+    
+    deleteBook(id);
+    return true;
+}
+
+bool BookArchive::commandDeleteMany(CommandTokenizer& args, std::string& error) {
+    std::vector<int> ids;
+    // line is the line number within the ID file, 0 for ids typed on the command
+    auto addIds = [&](std::string_view text, size_t line) {
+        // Ids are separated by commas and/or whitespace
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find_first_of(", \t\r", pos);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            std::string_view token = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (token.empty()) {
+                continue;
+            }
+            int id = 0;
+            if (!CommandTokenizer::parseNumber(token, id)) {
+                // Never echo file contents: the file may be anything the process can read
+                error = line == 0 ? "Invalid book ID: " + std::string(token)
+                                  : "Invalid book ID on line " + std::to_string(line) + " of the ID file";
+                return false;
+            }
+            ids.push_back(id);
+        }
+        return true;
+    };
     
-    char* errmsg = nullptr;
-    rc = sqlite3_exec(db, createTableSQL, nullptr, nullptr, &errmsg);
-    if (rc != SQLITE_OK) {
-        log(LogLevel::ERROR, "Failed to create table: " + std::string(errmsg));
-        sqlite3_free(errmsg);
+    if (args.peek() == "--file") {
+        args.next();
+        std::string_view filename = args.next();
+        if (filename.empty()) {
+            error = "Missing ID file. Use: delete-many --file <file>";
+            return false;
+        }
+        std::ifstream file{std::string(filename)};
+        if (!file.is_open()) {
+            error = "Cannot open ID file '" + std::string(filename) + "'";
+            return false;
+        }
+        std::string line;
+        size_t number = 0;
+        while (std::getline(file, line)) {
+            if (!addIds(line, ++number)) {
+                return false;
+            }
+        }
+    } else if (!addIds(args.rest(), 0)) {
         return false;
     }
     
-    // Create index for faster search
-    const char* createIndexSQL =
-        "CREATE INDEX IF NOT EXISTS idx_books_title_author ON books(title, author);";
-    
-    rc = sqlite3_exec(db, createIndexSQL, nullptr, nullptr, &errmsg);
-    if (rc != SQLITE_OK) {
-        log(LogLevel::ERROR, "Failed to create index: " + std::string(errmsg));
-        sqlite3_free(errmsg);
-        // Continue despite index creation error
+    if (ids.empty()) {
+        error = "Missing book IDs. Use: delete-many <id>, <id>, ... or delete-many --file <file>";
+        return false;
     }
     
+    deleteBooks(ids);
     return true;
 }
 
-void BookArchive::log(LogLevel level, const std::string& message) {
-    // Skip logging if the level is below current_log_level
-    if (level < current_log_level) {
-        return;
+bool BookArchive::commandDeleteRange(CommandTokenizer& args, std::string& error) {
+    int lo;
+    int hi;
+    if (!parseId(args, lo, error) || !parseId(args, hi, error)) {
+        error += ". Use: delete-range <first_id> <last_id>";
+        return false;
     }
-    
-    // Skip all non-error logs in release mode
-    #ifndef DEBUG_MODE
-    if (level != LogLevel::ERROR) {
-        return;
+    if (lo > hi || !args.atEnd()) {
+        error = "Invalid range. Use: delete-range <first_id> <last_id> (first_id <= last_id)";
+        return false;
     }
-    #endif
     
-    //exit function if log file is not open
-    if (!log_file.is_open()) {
-        return;
+    deleteRange(lo, hi);
+    return true;
+}
+
+bool BookArchive::commandUpdate(CommandTokenizer& args, std::string& error) {
+    int id;
+    std::string_view newTitle, newAuthor;
+    if (!parseId(args, id, error) || 
+        !parseTitleAuthor(args, newTitle, newAuthor, "Invalid format. Use: update <id> <new_title>, <new_author>", error)) {
+        return false;
     }
     
-    std::lock_guard<std::mutex> lock(log_mutex);
-    
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream timestamp;
-    timestamp << std::put_time(std::localtime(&now_time_t), "%Y-%m-%d %H:%M:%S")
-              << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    
-    log_file << "[" << timestamp.str() << "] [" << logLevelToString(level) << "] "
-             << message << std::endl;
-    
-    // Explicitely calling flush to ensure the error logs are immidiately writen on to the disk.
-    if (level == LogLevel::ERROR) {
-        log_file.flush();
-    }
+    updateBook(id, newTitle, newAuthor);
+    return true;
 }
 
-void BookArchive::cleanupStatements() {
-    std::lock_guard<std::shared_mutex> lock(stmt_cache_mutex);
-    for (auto& stmt_pair : stmt_cache) {
-        if (stmt_pair.second) {
-            sqlite3_finalize(stmt_pair.second);
-            stmt_pair.second = nullptr;
-        }
+bool BookArchive::commandGet(CommandTokenizer& args, std::string& error) {
+    OutputFormat format = output_format;
+    int id;
+    if (!parseFormatOption(args, format, error) || !parseId(args, id, error)) {
+        return false;
     }
     
-    stmt_cache.clear();
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    std::optional<Book> book = getBook(id);
+    if (!book) {
+        sink->note("No book found with ID " + std::to_string(id) + ".");
+    } else {
+        sink->header();
+        sink->row(book->id, book->title, book->author);
+    }
+    return true;
 }
 
-sqlite3_stmt* BookArchive::getPreparedStatement(const std::string& sql) {
-    // First try to find in cache with read lock
-    {
-        std::shared_lock<std::shared_mutex> cache_lock(stmt_cache_mutex);
-        auto it = stmt_cache.find(sql);
-        if (it != stmt_cache.end()) {
-            return it->second;
-        }
+bool BookArchive::commandSearch(CommandTokenizer& args, std::string& error) {
+    PageOptions page;
+    OutputFormat format = output_format;
+    if (!parsePageOptions(args, page, format, error)) {
+        return false;
     }
     
-    // Need to prepare the statement and add to cache
-    std::lock_guard<std::shared_mutex> cache_lock(stmt_cache_mutex);
-    // Check again after acquiring write lock
-    auto it = stmt_cache.find(sql);
-    if (it != stmt_cache.end()) {
-        return it->second;
+    std::string keyword(args.rest());
+    if (keyword.empty()) {
+        error = "Missing search keyword";
+        return false;
     }
     
-    // Prepare statement
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        log(LogLevel::ERROR, "Failed to prepare statement: " + 
-            std::string(sqlite3_errmsg(db)) + " for SQL: " + sql);
-        return nullptr;
+    // Through searchBook, so repeated searches are answered from the cache
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    BookResults results = searchBook(keyword, probePage(page));
+    std::optional<int> nextAfter;
+    size_t shown = printPage(results, page.limit, "Search Results for '" + keyword + "':", nextAfter, *sink);
+    
+    if (shown == 0) {
+        std::string after = page.after_id ? " after ID " + std::to_string(*page.after_id) : "";
+        sink->note("No books found matching '" + keyword + "'" + after + ".");
+    } else if (nextAfter) {
+        sink->note("\nShowing " + std::to_string(shown) + " book(s). Next page: search --after " + 
+                   std::to_string(*nextAfter) + " --limit " + std::to_string(page.limit) + " " + keyword);
     }
-    // Add to cache
-    stmt_cache[sql] = stmt;
-    return stmt;
+    return true;
 }
 
-bool BookArchive::executeSQLWithParams(const std::string& sql, 
-                                        const std::vector<std::string>& params) {
-    log(LogLevel::DEBUG, "Executing SQL: " + sql + " with " + 
-        std::to_string(params.size()) + " parameters");
-    
-    sqlite3_stmt* stmt = getPreparedStatement(sql);
-    if (!stmt) {
+bool BookArchive::commandSearchMany(CommandTokenizer& args, std::string& error) {
+    std::vector<std::string> keywords;
+    OutputFormat format = output_format;
+    if (!parseFormatOption(args, format, error)) {
         return false;
     }
-
-    
-    // Reset statement before binding parameters
-    sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
     
-    // Bind parameters
-    for (size_t i = 0; i < params.size(); ++i) {
-        int rc = sqlite3_bind_text(stmt, i + 1, params[i].c_str(), -1, SQLITE_TRANSIENT);
-        if (rc != SQLITE_OK) {
-            log(LogLevel::ERROR, "Failed to bind parameter " + std::to_string(i + 1) + 
-                ": " + std::string(sqlite3_errmsg(db)));
+    if (args.peek() == "--file") {
+        args.next();
+        std::string_view filename = args.next();
+        if (filename.empty()) {
+            error = "Missing keyword file. Use: search-many --file <file>";
+            return false;
+        }
+        std::ifstream file{std::string(filename)};
+        if (!file.is_open()) {
+            error = "Cannot open keyword file '" + std::string(filename) + "'";
             return false;
         }
+        std::string line;
+        while (std::getline(file, line)) {
+            keywords.push_back(line);
+        }
+    } else {
+        // Comma-separated, like the title and author of add
+        std::string_view rest = args.rest();
+        while (!rest.empty()) {
+            size_t comma = rest.find(',');
+            keywords.emplace_back(CommandTokenizer::trim(rest.substr(0, comma)));
+            rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        }
     }
     
-    // Execute with retry for SQLITE_BUSY errors
-    int retries = 0;
-    int rc;
-
-    {
-        std::lock_guard<std::shared_mutex> lock(db_mutex);
-        while ((rc = sqlite3_step(stmt)) == SQLITE_BUSY && retries < SQLITE_MAX_RETRIES) {
-            log(LogLevel::DEBUG, "Database busy, retrying... (" + 
-                std::to_string(retries + 1) + "/" + std::to_string(SQLITE_MAX_RETRIES) + ")");
-            std::this_thread::sleep_for(std::chrono::milliseconds(10 * (1 << retries)));
-            retries++;
-        }
+    auto start = std::chrono::steady_clock::now();
+    BookResults books = searchBooks(keywords);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    if (books.empty()) {
+        sink->note("No books found matching any of the keywords.");
+        return true;
     }
     
-    if (rc != SQLITE_DONE) {
-        log(LogLevel::ERROR, "Failed to execute SQL: " + std::string(sqlite3_errmsg(db)));
-        return false;
+    sink->note("Search Results for " + std::to_string(keywords.size()) + " keyword(s):");
+    sink->header();
+    for (const BookView& book : books) {
+        sink->row(book.id, book.title, book.author);
     }
+    sink->note("\nTotal: " + std::to_string(books.size()) + " book(s) " + formatThroughput(books.size(), seconds));
     return true;
 }
 
-std::vector<Book> BookArchive::executeQuery(const std::string& sql, 
-                                             const std::vector<std::string>& params) {
-    log(LogLevel::DEBUG, "Executing query: " + sql);
-    
-    std::vector<Book> results;
+bool BookArchive::commandAuthor(CommandTokenizer& args, std::string& error) {
+    PageOptions page;
+    OutputFormat format = output_format;
+    if (!parsePageOptions(args, page, format, error)) {
+        return false;
+    }
     
-    sqlite3_stmt* stmt = getPreparedStatement(sql);
-    if (!stmt) {
-        return results;
+    std::string author(args.rest());
+    if (author.empty()) {
+        error = "Missing author name";
+        return false;
     }
     
-    // Reset statement and clear bindings
-    sqlite3_reset(stmt);
-    sqlite3_clear_bindings(stmt);
+    log(LogLevel::INFO, "Listing books by author: '" + author + "'");
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    Cursor results = streamBooksByAuthor(author, probePage(page));
+    std::optional<int> nextAfter;
+    size_t shown = printPage(results, page.limit, "Books by '" + author + "':", nextAfter, *sink);
     
-    // Bind parameters
-    for (size_t i = 0; i < params.size(); ++i) {
-        int rc = sqlite3_bind_text(stmt, i + 1, params[i].c_str(), -1, SQLITE_TRANSIENT);
-        if (rc != SQLITE_OK) {
-            log(LogLevel::ERROR, "Failed to bind parameter " + std::to_string(i + 1) + 
-                ": " + std::string(sqlite3_errmsg(db)));
-            return results;
-        }
+    if (shown == 0) {
+        std::string after = page.after_id ? " after ID " + std::to_string(*page.after_id) : "";
+        sink->note("No books found by '" + author + "'" + after + ".");
+    } else if (nextAfter) {
+        sink->note("\nShowing " + std::to_string(shown) + " book(s). Next page: author --after " + 
+                   std::to_string(*nextAfter) + " --limit " + std::to_string(page.limit) + " " + author);
+    }
+    return true;
+}
+
+bool BookArchive::commandChanges(CommandTokenizer& args, std::string& error) {
+    PageOptions page;
+    page.limit = CHANGE_FEED_PAGE_SIZE;
+    OutputFormat format = output_format;
+    if (!parsePageOptions(args, page, format, error)) {
+        return false;
     }
     
-    // Execute with retry for SQLITE_BUSY errors
-    int retries = 0;
-    int rc;
+    int64_t seq = 0;
+    std::string_view token = args.next();
+    if (page.after_id || (!token.empty() && !CommandTokenizer::parseNumber(token, seq)) || seq < 0 || !args.atEnd()) {
+        error = "Invalid format. Use: changes [--limit N] [<seq>]";
+        return false;
+    }
     
-    while (true) {
-        {
-            //shared lock for all reads
-            std::shared_lock<std::shared_mutex> lock(db_mutex);
-            rc = sqlite3_step(stmt);
-        }
-        
-        if (rc == SQLITE_ROW) {
-            Book book;
-            book.id = sqlite3_column_int(stmt, 0);
-            
-            const char* title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            const char* author = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-            
-            book.title = title ? title : "";
-            book.author = author ? author : "";
-            
-            results.push_back(book);
-        } else if (rc == SQLITE_BUSY && retries < SQLITE_MAX_RETRIES) {
-            log(LogLevel::DEBUG, "Database busy, retrying... (" + 
-                std::to_string(retries + 1) + "/" + std::to_string(SQLITE_MAX_RETRIES) + ")");
-            std::this_thread::sleep_for(std::chrono::milliseconds(10 * (1 << retries)));
-            retries++;
-            continue;
-        } else if (rc == SQLITE_DONE) {
-            break;
-        } else {
-            log(LogLevel::ERROR, "Failed to execute query: " + std::string(sqlite3_errmsg(db)));
-            break;
-        }
+    ChangeFeed feed = changesSince(seq, page.limit);
+    if (feed.resync) {
+        // An error rather than a note, so TSV and JSON consumers see it too
+        error = "Deletions after seq " + std::to_string(seq) + " were compacted away; resync from 0";
+        return false;
     }
     
-    if (!results.empty()) {
-        log(LogLevel::DEBUG, "Query returned " + std::to_string(results.size()) + " results");
-    } else {
-        log(LogLevel::DEBUG, "Query returned no results");
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    if (feed.changes.empty()) {
+        sink->note("No changes after seq " + std::to_string(seq) + ".");
+        return true;
     }
     
-    return results;
+    sink->note("Changes after seq " + std::to_string(seq) + ":");
+    sink->changeHeader();
+    for (const BookChange& change : feed.changes) {
+        sink->changeRow(change.seq, change.opName(), change.book.id, change.book.title, change.book.author);
+    }
+    if (feed.more) {
+        sink->note("\nShowing " + std::to_string(feed.changes.size()) + " change(s). Next page: changes --limit " + 
+                   std::to_string(page.limit) + " " + std::to_string(feed.next_seq));
+    } else {
+        sink->note("\nUp to date at seq " + std::to_string(feed.next_seq) + ".");
+    }
+    return true;
 }
 
-bool BookArchive::addBook(int id, const std::string& title, const std::string& author) {
-    log(LogLevel::INFO, "Adding book: ID=" + std::to_string(id) + ", Title='" + title + "', Author='" + author + "'");
+bool BookArchive::commandSuggest(CommandTokenizer& args, std::string& error) {
+    PageOptions page;
+    page.limit = SUGGEST_DEFAULT_LIMIT;
+    OutputFormat format = output_format;
+    if (!parsePageOptions(args, page, format, error)) {
+        return false;
+    }
     
-    const std::string sql = "INSERT INTO books (id, title, author) VALUES (?, ?, ?);";
-    std::vector<std::string> params = {
-        std::to_string(id),
-        title,
-        author
-    };
-    if (!executeSQLWithParams(sql, params)) {
-        log(LogLevel::ERROR, "Failed to add book");
-        std::cout << "Error: Failed to add the book. Check logs for details." << std::endl;
+    // A number after the prefix is the limit: suggest harry 5
+    std::string_view prefix = args.rest();
+    size_t space = prefix.find_last_of(" \t");
+    if (space != std::string_view::npos && CommandTokenizer::parseNumber(prefix.substr(space + 1), page.limit)) {
+        prefix = CommandTokenizer::trim(prefix.substr(0, space));
+    }
+    if (page.after_id || prefix.empty()) {
+        error = "Invalid format. Use: suggest [--limit N] <prefix> [limit]";
         return false;
     }
     
-    std::cout << "Book added successfully!" << std::endl;
+    std::vector<SuggestIndex::Suggestion> found = suggest(prefix, page.limit);
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    if (found.empty()) {
+        sink->note("No titles or authors start with '" + std::string(prefix) + "'.");
+        return true;
+    }
+    
+    sink->note("Suggestions for '" + std::string(prefix) + "':");
+    sink->suggestionHeader();
+    for (const SuggestIndex::Suggestion& suggestion : found) {
+        sink->suggestionRow(suggestion.kindName(), suggestion.text, suggestion.books);
+    }
     return true;
 }
 
-bool BookArchive::deleteBook(int id) {
-    log(LogLevel::INFO, "Deleting book with ID: " + std::to_string(id));
-    
-    const std::string sql = "DELETE FROM books WHERE id = ?;";
-    std::vector<std::string> params = {std::to_string(id)};
+bool BookArchive::commandImport(CommandTokenizer& args, std::string& error) {
+    std::string_view filename = args.next();
+    if (filename.empty()) {
+        error = "Missing import file. Use: import <file> [batch_size]";
+        return false;
+    }
     
-    if (!executeSQLWithParams(sql, params)) {
-        log(LogLevel::ERROR, "Failed to delete book");
-        std::cout << "Error: Failed to delete the book. Check logs for details." << std::endl;
+    size_t batchSize = IMPORT_BATCH_SIZE;
+    std::string_view batchStr = args.next();
+    if (!batchStr.empty() && !CommandTokenizer::parseNumber(batchStr, batchSize)) {
+        error = "Invalid batch size: " + std::string(batchStr);
         return false;
     }
     
-    std::cout << "Book deleted successfully!" << std::endl;
+    importBooks(std::string(filename), batchSize);
     return true;
 }
 
-bool BookArchive::updateBook(int id, const std::string& newTitle, const std::string& newAuthor) {
-    log(LogLevel::INFO, "Updating book: ID=" + std::to_string(id) + 
-        ", New Title='" + newTitle + "', New Author='" + newAuthor + "'");
-    
-    const std::string sql = "UPDATE books SET title = ?, author = ? WHERE id = ?;";
-    std::vector<std::string> params = {
-        newTitle,
-        newAuthor,
-        std::to_string(id)
-    };
+bool BookArchive::commandExport(CommandTokenizer& args, std::string& error) {
+    std::string_view filename = args.next();
+    if (filename.empty()) {
+        error = "Missing export file. Use: export <file>";
+        return false;
+    }
     
-    if (!executeSQLWithParams(sql, params)) {
-        log(LogLevel::ERROR, "Failed to update book");
-        std::cout << "Error: Failed to update the book. Check logs for details." << std::endl;
+    exportBooks(std::string(filename));
+    return true;
+}
+
+bool BookArchive::commandExportSnapshot(CommandTokenizer& args, std::string& error) {
+    std::string_view filename = args.next();
+    if (filename.empty()) {
+        error = "Missing snapshot file. Use: export-snapshot <file>";
         return false;
     }
     
-    std::cout << "Book updated successfully!" << std::endl;
+    exportSnapshot(std::string(filename));
     return true;
 }
 
-std::vector<Book> BookArchive::searchBook(const std::string& keyword) {
-    log(LogLevel::INFO, "Searching for books with keyword: '" + keyword + "'");
+bool BookArchive::commandLoadSnapshot(CommandTokenizer& args, std::string& error) {
+    std::string_view filename = args.next();
+    if (filename.empty()) {
+        error = "Missing snapshot file. Use: load-snapshot <file> [batch_size]";
+        return false;
+    }
     
-    const std::string sql = 
-        "SELECT * FROM books WHERE title LIKE ? OR author LIKE ? ORDER BY id;";
+    size_t batchSize = IMPORT_BATCH_SIZE;
+    std::string_view batchStr = args.next();
+    if (!batchStr.empty() && !CommandTokenizer::parseNumber(batchStr, batchSize)) {
+        error = "Invalid batch size: " + std::string(batchStr);
+        return false;
+    }
     
-    std::string searchPattern = "%" + keyword + "%";
-    std::vector<std::string> params = {searchPattern, searchPattern};
+    loadSnapshot(std::string(filename), batchSize);
+    return true;
+}
+
+bool BookArchive::commandDisplay(CommandTokenizer& args, std::string& error) {
+    // Bare 'display' shows one page so large archives stay usable
+    PageOptions page;
+    page.limit = DISPLAY_PAGE_SIZE;
+    OutputFormat format = output_format;
+    if (!parsePageOptions(args, page, format, error)) {
+        return false;
+    }
+    if (!args.atEnd()) {
+        error = "Invalid format. Use: display [--after <id>] [--limit N] [--format F]";
+        return false;
+    }
     
-    std::vector<Book> results = executeQuery(sql, params);
+    log(LogLevel::INFO, "Displaying books");
+    std::unique_ptr<OutputSink> sink = OutputSink::create(format, console());
+    Cursor results = streamBooks(probePage(page));
+    std::optional<int> nextAfter;
+    std::string title = page.after_id ? "Book Archive - Books after ID " + std::to_string(*page.after_id) + ":"
+                                      : "Book Archive - All Books:";
+    size_t shown = printPage(results, page.limit, title, nextAfter, *sink);
     
-    if (results.empty()) {
-        std::cout << "No books found matching '" << keyword << "'." << std::endl;
+    if (shown == 0) {
+        sink->note(page.after_id ? "No books found after ID " + std::to_string(*page.after_id) + "."
+                                 : "No books found in the database.");
+    } else if (nextAfter) {
+        sink->note("\nShowing " + std::to_string(shown) + " book(s). Next page: display --after " + 
+                   std::to_string(*nextAfter) + " --limit " + std::to_string(page.limit));
+    } else if (page.after_id) {
+        sink->note("\nShowing " + std::to_string(shown) + " book(s). End of archive.");
     } else {
-        std::cout << "Search Results for '" << keyword << "':" << std::endl;
-        std::cout << std::setw(5) << "ID" << " | " 
-                  << std::setw(30) << "Title" << " | " 
-                  << std::setw(20) << "Author" << std::endl;
-        std::cout << std::string(60, '-') << std::endl;
-        
-        for (const auto& book : results) {
-            std::cout << std::setw(5) << book.id << " | " 
-                      << std::setw(30) << (book.title.length() > 30 ? book.title.substr(0, 27) + "..." : book.title) << " | " 
-                      << std::setw(20) << (book.author.length() > 20 ? book.author.substr(0, 17) + "..." : book.author) 
-                      << std::endl;
-        }
+        sink->note("\nTotal: " + std::to_string(shown) + " book(s)");
     }
-    
-    return results;
+    return true;
 }
 
-void BookArchive::displayBooks() {
-    log(LogLevel::INFO, "Displaying all books");
-    
-    const std::string sql = "SELECT * FROM books ORDER BY id;";
-    std::vector<Book> results = executeQuery(sql);
-    
-    if (results.empty()) {
-        std::cout << "No books found in the database." << std::endl;
+bool BookArchive::commandStats(CommandTokenizer& args, std::string& error) {
+    std::string_view option = args.next();
+    if (option == "reset") {
+        resetStats();
+        console() << "Statistics reset." << std::endl;
+    } else if (option.empty()) {
+        printStats();
     } else {
-        std::cout << "Book Archive - All Books:" << std::endl;
-        std::cout << std::setw(5) << "ID" << " | " 
-                  << std::setw(30) << "Title" << " | " 
-                  << std::setw(20) << "Author" << std::endl;
-        std::cout << std::string(60, '-') << std::endl;
-        
-        for (const auto& book : results) {
-            std::cout << std::setw(5) << book.id << " | " 
-                      << std::setw(30) << (book.title.length() > 30 ? book.title.substr(0, 27) + "..." : book.title) << " | " 
-                      << std::setw(20) << (book.author.length() > 20 ? book.author.substr(0, 17) + "..." : book.author) 
-                      << std::endl;
-        }
-        
-        std::cout << "\nTotal: " << results.size() << " book(s)" << std::endl;
+        error = "Invalid format. Use: stats [reset]";
+        return false;
     }
+    return true;
 }
 
-void BookArchive::help() {
-    std::cout << "\nBook Archive " << VERSION << " - Command List\n" << std::endl;
-    std::cout << "  add <id> <title>, <author>              - Add a new book" << std::endl;
-    std::cout << "  delete <id>                             - Delete a book by ID" << std::endl;
-    std::cout << "  update <id> <new_title>, <new_author>   - Update a book's information based on ID" << std::endl;
-    std::cout << "  search <keyword>                        - Search books by title or author" << std::endl;
-    std::cout << "  display                                 - Show all books in the database" << std::endl;
-    std::cout << "  help                                    - Show this help menu" << std::endl;
-    std::cout << "  version                                 - Display the tool version" << std::endl;
-    std::cout << "  debug                                   - Toggle debug logging (if compiled with DEBUG_MODE)" << std::endl;
-    std::cout << "  exit                                    - Quit the program\n" << std::endl;
+bool BookArchive::commandHelp(CommandTokenizer&, std::string&) {
+    help();
+    return true;
 }
 
-void BookArchive::version() {
-    std::cout << "Book Archive Version: " << VERSION << std::endl;
-    std::cout << "Build date: " << __DATE__ << " " << __TIME__ << std::endl;
-    std::cout << "SQLite version: " << sqlite3_libversion() << std::endl;
-    
+bool BookArchive::commandVersion(CommandTokenizer&, std::string&) {
+    version();
+    return true;
+}
+
+bool BookArchive::commandDebug(CommandTokenizer&, std::string&) {
     #ifdef DEBUG_MODE
-    std::cout << "Build type: Debug" << std::endl;
+    if (current_log_level == LogLevel::DEBUG) {
+        setLogLevel(LogLevel::INFO);
+        console() << "Logging level switched to INFO. Showing all logs." << std::endl;
+    } else {
+        setLogLevel(LogLevel::DEBUG);
+        console() << "Logging level switched to DEBUG. Recording all DEBUG and ERROER logs only." << std::endl;
+    }
     #else
-    std::cout << "Build type: Release" << std::endl;
+    console() << "Logging level switching is not available in release build. Log level set to ERROR" << std::endl;
     #endif
+    return true;
 }
 
-void BookArchive::setLogLevel(LogLevel level) {
-    current_log_level = level;
-    log(LogLevel::INFO, "Log level set to: " + logLevelToString(level));
+bool BookArchive::commandExit(CommandTokenizer&, std::string&) {
+    running = false;
+    console() << "Exiting Book Archive. Goodbye!" << std::endl;
+    return true;
 }
 
-void BookArchive::processCommand(const std::string& command) {
-    std::istringstream iss(command);
-    std::string action;
-    iss >> action;
+void BookArchive::run() {
+    console() << "Book Archive " << VERSION << " - Library Management Tool" << std::endl;
+    console() << "Type 'help' for available commands, 'exit' to quit." << std::endl;
     
-    try {
-        if (action == "add") {
-            int id;
-            std::string title, author, idStr;
-            
-            // Parse ID first
-            iss >> idStr;
-            if (idStr.empty()) {
-                throw std::runtime_error("Missing book ID");
-            }
-            
-            try {
-                id = std::stoi(idStr);
-            } catch (const std::exception& e) {
-                throw std::runtime_error("Invalid book ID: " + idStr);
-            }
-            
-            // Parse title and author
-            std::string remainder;
-            std::getline(iss, remainder);
-            
-            size_t commaPos = remainder.find(',');
-            if (commaPos == std::string::npos) {
-                throw std::runtime_error("Invalid format. Use: add <id> <title>, <author>");
-            }
-            
-            title = remainder.substr(0, commaPos);
-            author = remainder.substr(commaPos + 1);
-            
-            // Trim whitespace before and after
-            title.erase(0, title.find_first_not_of(" \t"));
-            title.erase(title.find_last_not_of(" \t") + 1);
-            author.erase(0, author.find_first_not_of(" \t"));
-            author.erase(author.find_last_not_of(" \t") + 1);
-            
-            if (title.empty() || author.empty()) {
-                throw std::runtime_error("Title and author cannot be empty");
-            }
+    std::string command;
+    while (running) {
+        console() << "\n> ";
+        if (!std::getline(std::cin, command)) {
+            // End of input (Ctrl-D or a closed pipe)
+            console() << std::endl;
+            break;
+        }
+        
+        if (!command.empty()) {
+            processCommand(command);
+        }
+    }
+}
 
-            addBook(id, title, author);
-        } else if (action == "delete") {
-            int id;
-            std::string idStr;
-            iss >> idStr;
-            
-            if (idStr.empty()) {
-                throw std::runtime_error("Missing book ID");
-            }
-            
-            try {
-                id = std::stoi(idStr);
-            } catch (const std::exception& e) {
-                throw std::runtime_error("Invalid book ID: " + idStr);
-            }
-            
-            deleteBook(id);
-        } else if (action == "update") {
-            int id;
-            std::string newTitle, newAuthor, idStr;
-            
-            // Parse ID first
-            iss >> idStr;
-            if (idStr.empty()) {
-                throw std::runtime_error("Missing book ID");
-            }
-            
-            try {
-                id = std::stoi(idStr);
-            } catch (const std::exception& e) {
-                throw std::runtime_error("Invalid book ID: " + idStr);
-            }
-            
-            // Parse title and author
-            std::string remainder;
-            std::getline(iss, remainder);
-            
-            size_t commaPos = remainder.find(',');
-            if (commaPos == std::string::npos) {
-                throw std::runtime_error("Invalid format. Use: update <id> <new_title>, <new_author>");
-            }
-            
-            newTitle = remainder.substr(0, commaPos);
-            newAuthor = remainder.substr(commaPos + 1);
-            
-            // Trim whitespace
-            newTitle.erase(0, newTitle.find_first_not_of(" \t"));
-            newTitle.erase(newTitle.find_last_not_of(" \t") + 1);
-            newAuthor.erase(0, newAuthor.find_first_not_of(" \t"));
-            newAuthor.erase(newAuthor.find_last_not_of(" \t") + 1);
-            
-            if (newTitle.empty() || newAuthor.empty()) {
-                throw std::runtime_error("Title and author cannot be empty");
-            }
-            
-            updateBook(id, newTitle, newAuthor);
-        } else if (action == "search") {
-            std::string keyword;
-            std::getline(iss >> std::ws, keyword);
-            
-            if (keyword.empty()) {
-                throw std::runtime_error("Missing search keyword");
-            }
-            
-            searchBook(keyword);
-        } else if (action == "display") {
-            displayBooks();
-        } else if (action == "help") {
-            help();
-        } else if (action == "version") {
-            version();
-        } else if (action == "debug") {
-            #ifdef DEBUG_MODE
-            if (current_log_level == LogLevel::DEBUG) {
-                setLogLevel(LogLevel::INFO);
-                std::cout << "Logging level switched to INFO. Showing all logs." << std::endl;
-            } else {
-                setLogLevel(LogLevel::DEBUG);
-                std::cout << "Logging level switched to DEBUG. Recording all DEBUG and ERROER logs only." << std::endl;
-            }
-            #else
-            std::cout << "Logging level switching is not available in release build. Log level set to ERROR" << std::endl;
-            #endif
-        } else if (action == "exit") {
-            running = false;
-            std::cout << "Exiting Book Archive. Goodbye!" << std::endl;
-        } else {
-            std::cout << "Invalid command. Type 'help' for a list of commands." << std::endl;
+// Collects console output in a large buffer and ignores flush requests
+// (std::endl), writing through to the real stream only when full or finished
+class BatchOutputBuffer : public std::streambuf {
+public:
+    explicit BatchOutputBuffer(std::streambuf* target) : target(target), buffer(BATCH_OUTPUT_BUFFER_SIZE) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+    ~BatchOutputBuffer() override { flushAll(); }
+    
+    void flushAll() {
+        drain();
+        target->pubsync();
+    }
+    
+protected:
+    int overflow(int c) override {
+        drain();
+        if (c != traits_type::eof()) {
+            sputc(static_cast<char>(c));
         }
-    } catch (const std::exception& e) {
-        std::cout << "Error: " << e.what() << std::endl;
-        log(LogLevel::ERROR, "Command error: " + std::string(e.what()) + " (Command: " + command + ")");
+        return traits_type::not_eof(c);
+    }
+    
+    int sync() override { return 0; }
+    
+private:
+    void drain() {
+        target->sputn(pbase(), pptr() - pbase());
+        setp(buffer.data(), buffer.data() + buffer.size());
     }
+    
+    std::streambuf* target;
+    std::vector<char> buffer;
+};
+
+static bool isMutation(std::string_view action) {
+    return action == "add" || action == "update" || action == "delete";
 }
 
-void BookArchive::run() {
-    std::cout << "Book Archive " << VERSION << " - Library Management Tool" << std::endl;
-    std::cout << "Type 'help' for available commands, 'exit' to quit." << std::endl;
+void BookArchive::runBatch(std::istream& input, size_t group_size) {
+    BatchOutputBuffer output(std::cout.rdbuf());
+    std::streambuf* previous = std::cout.rdbuf(&output);
+    
+    // The open transaction spans whole commands, so it is begun and committed
+    // under db_mutex but not held across them; nothing else writes in batch mode
+    auto transaction = [this](const char* sql) {
+        std::lock_guard<std::shared_mutex> lock(db_mutex);
+        return executeRawSQL(sql);
+    };
+    auto begin = [this]() {
+        std::unique_lock<std::shared_mutex> lock(db_mutex);
+        return beginImmediate(lock);
+    };
+    size_t grouped = 0;  // Mutations in the open transaction
+    size_t commands = 0;
+    bool in_group = false;
+    
+    auto commitGroup = [&]() {
+        if (in_group && !transaction("COMMIT;")) {
+            transaction("ROLLBACK;");
+            console() << "Error: Failed to commit the last " << grouped << " change(s). Check logs for details." << std::endl;
+        }
+        
+        // The grouped writes invalidated before this commit made them visible
+        if (in_group) {
+            search_cache.invalidate();
+        }
+        in_group = false;
+        grouped = 0;
+    };
     
     std::string command;
-    while (running) {
-        std::cout << "\n> ";
-        std::getline(std::cin, command);
+    while (running && std::getline(input, command)) {
+        std::string_view action = CommandTokenizer(command).next();
+        if (action.empty() || action[0] == '#') {
+            continue;  // Blank lines and script comments
+        }
+        commands++;
         
-        if (!command.empty()) {
+        if (group_size > 1 && isMutation(action) && writable()) {
+            if (!in_group) {
+                in_group = begin();
+            }
             processCommand(command);
+            if (in_group && ++grouped >= group_size) {
+                commitGroup();
+            }
+            continue;
         }
+        
+        // Reads use other connections and must see every earlier change
+        commitGroup();
+        processCommand(command);
     }
+    commitGroup();
+    
+    log(LogLevel::INFO, "Batch finished after " + std::to_string(commands) + " command(s)");
+    output.flushAll();
+    std::cout.rdbuf(previous);
 }
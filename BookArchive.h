@@ -31,58 +31,330 @@
 #include <optional>
 #include <memory>
 #include <iomanip>
+#include <tuple>
+#include <string_view>
+#include <iterator>
+#include <future>
+#include <deque>
+#include <condition_variable>
+#include "ConnectionPool.h"
+#include "AsyncLogger.h"
+#include "SqlBind.h"
+#include "BookCache.h"
+#include "ArchiveStats.h"
+#include "CommandTokenizer.h"
+#include "BookSnapshot.h"
+#include "InternedString.h"
+#include "BookResults.h"
+#include "DatabaseConfig.h"
+#include "OutputSink.h"
+#include "SuggestIndex.h"
+#include "TextScan.h"
+#include "QueryExecutor.h"
+#include "SearchCache.h"
 
 #define VERSION "1.0.0"
-#define SQLITE_MAX_RETRIES 5
+#define BUSY_BACKOFF_MIN_US 100     // First busy backoff; doubles per retry, with jitter
+#define BUSY_BACKOFF_MAX_US 20000   // Longest single backoff
+#define BUSY_LOCKED_WAIT_MS 2       // Longest wait for the write lock while holding db_mutex
+#define IMPORT_BATCH_SIZE 1000
+#define DEFAULT_READ_CONNECTIONS 4
+#define DISPLAY_PAGE_SIZE 100
+#define BATCH_OUTPUT_BUFFER_SIZE 65536
+#define GROUP_COMMIT_MAX_WRITES 256
+#define GROUP_COMMIT_WINDOW_US 200
+#define CHANGE_FEED_PAGE_SIZE 1000     // Changes per call of the changes command by default
+#define CHANGE_TOMBSTONE_DAYS 7        // How long the change log remembers deleted books
+#define SNAPSHOT_SEARCH_CHUNK 65536   // Fewest snapshot books worth a search thread of their own
+#define SCHEMA_VERSION 2               // PRAGMA user_version of an archive with the schema below
 
-// Enum for log levels
-enum class LogLevel {
-    INFO,
-    DEBUG,
-    ERROR
+// Keyset pagination: only rows with id > after_id, at most limit of them
+struct PageOptions {
+    std::optional<int> after_id;  // Unset = start from the first book
+    size_t limit = 0;             // 0 = no limit
+    
+    bool paged() const { return after_id.has_value() || limit > 0; }
+};
+
+// The latest change to one book in the change log. Each book keeps only its
+// newest entry, so the log holds every live book plus recent deletions.
+struct BookChange {
+    enum class Op { INSERT, UPDATE, DELETE };
+    
+    int64_t seq;  // Increases with every change, never reused
+    Op op;
+    Book book;    // The book as it is now; only the id for deletes
+    
+    const char* opName() const;  // "insert", "update" or "delete"
+};
+
+// One page of the change feed. Applying the pages in order brings a replica
+// that had everything up to the requested seq up to date.
+struct ChangeFeed {
+    std::vector<BookChange> changes;  // In seq order
+    int64_t next_seq = 0;             // Pass to the next call: the last seq returned
+    bool more = false;                // limit stopped the page short
+    bool resync = false;              // Deletions after the requested seq were compacted away:
+                                      // rebuild the replica from seq 0
 };
 
-// Simple book structure matching the database schema
-struct Book {
-    int id;
-    std::string title;
-    std::string author;
+// Names a snapshot file to serve read-only (see BookSnapshot.h)
+struct SnapshotFile {
+    std::string path;
 };
 
 class BookArchive {
+public:
+    class Cursor;  // Streaming query results, defined below
+    
 private:
-    sqlite3* db;
+    sqlite3* db;  // Writer connection, guarded by db_mutex
     std::string db_filename;
     std::shared_mutex db_mutex;  // Shared mutex for reader/writer pattern
-    std::ofstream log_file;
-    std::mutex log_mutex;  // Mutex specifically for logging
+    AsyncLogger logger;  // Lock-free, batched writes to the log file
     std::atomic<bool> running;
-    LogLevel current_log_level;
+    std::atomic<LogLevel> current_log_level;
+    bool fts_enabled;  // FTS5 index available for searchBook
+    DatabaseConfig config;  // Pragmas applied when the connections are opened
+    OutputFormat output_format;  // How listing commands print books unless given --format
+    
+    // Prepared statement cache for the writer connection
+    StatementCache stmt_cache;
+    
+    // Read-only connections, each with its own statement cache
+    ConnectionPool read_pool;
+    size_t read_pool_size;
+    
+    // Read-through cache behind getBook, invalidated by every write
+    BookCache book_cache;
+    
+    // Result sets of searchBook, made stale by every committed write
+    SearchCache search_cache;
+    
+    // Snapshot mode: books are served from a mapped snapshot and SQLite is never opened
+    BookSnapshot snapshot;
+    bool snapshot_mode;
+    
+    // Phase latencies and busy-wait counters (empty unless built with ENABLE_STATS)
+    ArchiveStats stats;
+    
+    // Busy handler state of one kind of connection: how long SQLite may keep
+    // retrying a lock before returning SQLITE_BUSY
+    struct BusyPolicy {
+        BookArchive* owner;
+        int timeout_ms;
+        bool narrowed;  // Giving up is expected, the caller retries outside db_mutex
+    };
+    BusyPolicy writer_busy;  // Narrowed while taking the write lock, see beginImmediate
+    BusyPolicy reader_busy;
+    
+    // Group commit: mutations are queued for one writer thread, which runs
+    // everything waiting (up to GROUP_COMMIT_MAX_WRITES) in one transaction
+    struct WriteRequest {
+        std::function<bool()> apply;       // Runs on the writer thread with db_mutex held
+        std::optional<int> invalidate_id;  // Book to drop from the cache once committed
+        std::promise<bool> result;
+    };
+    std::deque<WriteRequest> write_queue;
+    std::mutex write_queue_mutex;
+    std::condition_variable write_queue_ready;
+    bool writer_stopping;
+    std::thread writer_thread;
+    
+    // Checkpoints the WAL and refreshes planner statistics in the background
+    ArchiveMaintenance maintenance;
+    
+    // Runs the asynchronous reads, one worker per read connection
+    QueryExecutor query_executor;
+    
+    // Typeahead index, built on the first suggest. The writer's temp triggers
+    // stage every title and author change; the commit hook applies them.
+    SuggestIndex suggest_index;
+    std::mutex suggest_build_mutex;
+    std::atomic<bool> suggest_ready;
+    bool suggest_uncommitted;  // Built inside a transaction that has not committed yet
+    std::vector<SuggestIndex::Change> suggest_staged;  // Guarded by db_mutex
+    
+    // Binds the caller's arguments to a leased statement, returns an SQLite result code
+    using BindFn = int (*)(sqlite3_stmt* stmt, const void* args, sqlite3_destructor_type lifetime);
+    
+    template <typename Tuple>
+    static int bindTuple(sqlite3_stmt* stmt, const void* args, sqlite3_destructor_type lifetime);
+    
+    // Execute SQL with typed parameter binding (prevents SQL injection).
+    // Caller must hold db_mutex, normally by running as a submitWrite() request.
+    template <typename... Args>
+    bool execute(const std::string& sql, const Args&... args);
+    
+    // Execute a query with typed parameter binding and collect results
+    template <typename... Args>
+    std::vector<Book> query(const std::string& sql, const Args&... args);
+    
+    // Open a streaming cursor over a query, arguments are copied into the statement
+    template <typename... Args>
+    Cursor cursor(const std::string& sql, const Args&... args);
     
-    // Prepared statement cache to improve performance
-    std::unordered_map<std::string, sqlite3_stmt*> stmt_cache;
-    std::shared_mutex stmt_cache_mutex;  // Protect statement cache
+    // First column of the first row on the writer connection, nullopt if there
+    // is no row, it is NULL or the query fails. Caller must hold db_mutex.
+    template <typename... Args>
+    std::optional<sqlite3_int64> queryInt(const std::string& sql, const Args&... args);
     
-    // Execute SQL with proper parameter binding (prevents SQL injection)
-    bool executeSQLWithParams(const std::string& sql, const std::vector<std::string>& params = {});
+    // Type-erased back ends of execute(), query(), cursor() and queryInt()
+    bool executeBound(const std::string& sql, BindFn bind, const void* args);
+    std::optional<sqlite3_int64> queryIntBound(const std::string& sql, BindFn bind, const void* args);
+    std::vector<Book> queryBound(const std::string& sql, BindFn bind, const void* args);
+    Cursor cursorBound(const std::string& sql, BindFn bind, const void* args, 
+                       sqlite3_destructor_type lifetime);
     
-    // Execute a query and collect results
-    std::vector<Book> executeQuery(const std::string& sql, const std::vector<std::string>& params = {});
+    // Queue a mutation for the writer thread, resolved with apply's result once committed
+    std::future<bool> submitWrite(std::function<bool()> apply, std::optional<int> invalidate_id);
     
-    // Command processing
-    void processCommand(const std::string& command);
+    // Key of a search in search_cache: the full-text query when there is one, so
+    // keywords differing only in case, spacing or punctuation share an entry
+    std::string searchCacheKey(const std::string& keyword, const PageOptions& page) const;
     
-    // Thread-safe logging with different levels
+    // Run read on the query executor; the future carries its result or exception
+    template <typename Fn>
+    auto submitRead(Fn read) -> std::future<decltype(read())>;
+    
+    // Writer thread: collect queued mutations and commit them in groups
+    void writerLoop();
+    void commitWriteGroup(std::vector<WriteRequest>& group);
+    
+    // Command processing: look the first word up in command_table and run its handler
+    void processCommand(std::string_view command);
+    void reportCommandError(std::string_view command, const std::string& error);
+    
+    // Command handlers. Each returns false with a message in error when its
+    // arguments are malformed.
+    using CommandHandler = bool (BookArchive::*)(CommandTokenizer& args, std::string& error);
+    struct CommandEntry {
+        std::string_view name;
+        CommandHandler handler;
+    };
+    static const CommandEntry command_table[];
+    
+    bool commandAdd(CommandTokenizer& args, std::string& error);
+    bool commandDelete(CommandTokenizer& args, std::string& error);
+    bool commandDeleteMany(CommandTokenizer& args, std::string& error);
+    bool commandDeleteRange(CommandTokenizer& args, std::string& error);
+    bool commandChanges(CommandTokenizer& args, std::string& error);
+    bool commandSuggest(CommandTokenizer& args, std::string& error);
+    bool commandUpdate(CommandTokenizer& args, std::string& error);
+    bool commandGet(CommandTokenizer& args, std::string& error);
+    bool commandSearch(CommandTokenizer& args, std::string& error);
+    bool commandSearchMany(CommandTokenizer& args, std::string& error);
+    bool commandAuthor(CommandTokenizer& args, std::string& error);
+    bool commandImport(CommandTokenizer& args, std::string& error);
+    bool commandExport(CommandTokenizer& args, std::string& error);
+    bool commandExportSnapshot(CommandTokenizer& args, std::string& error);
+    bool commandLoadSnapshot(CommandTokenizer& args, std::string& error);
+    bool commandDisplay(CommandTokenizer& args, std::string& error);
+    bool commandStats(CommandTokenizer& args, std::string& error);
+    bool commandHelp(CommandTokenizer& args, std::string& error);
+    bool commandVersion(CommandTokenizer& args, std::string& error);
+    bool commandDebug(CommandTokenizer& args, std::string& error);
+    bool commandExit(CommandTokenizer& args, std::string& error);
+    
+    // Thread-safe, non-blocking logging with different levels
     void log(LogLevel level, const std::string& message);
     
-    // Close and cleanup prepared statements
+    // Whether a record at this level would be written, lets hot paths skip building messages
+    bool isLogEnabled(LogLevel level) const;
+    
+    // Report cache counters, then finalize the writer's statements
     void cleanupStatements();
     
     // Initialize database and create schema
     bool initializeDatabase();
     
-    // Get prepared statement (thread-safe)
-    sqlite3_stmt* getPreparedStatement(const std::string& sql);
+    // Create or upgrade every table, index and trigger, then stamp SCHEMA_VERSION.
+    // Skipped when the archive already carries the stamp.
+    bool createSchema();
+    
+    // Read-only open: the schema must already exist, and is only looked at
+    bool checkSchema();
+    
+    // Move a database whose books table stores author text onto the authors table
+    bool migrateAuthors();
+    
+    // Create the FTS5 index and its sync triggers, backfilling on first use
+    bool initializeFullTextIndex();
+    
+    // Create the change log and the triggers that feed it, logging every
+    // existing book as inserted on first use
+    bool initializeChangeLog();
+    
+    // Hand WAL checkpoints to the maintenance thread (file databases in WAL mode)
+    void startMaintenance();
+    
+    // Register suggest_change() and the temp triggers and hooks that call it
+    bool initializeSuggestHooks();
+    
+    // SQLite callbacks: stage one book's old and new title and author, apply
+    // the staged changes when the transaction commits, drop them on rollback
+    static void suggestChange(sqlite3_context* context, int argc, sqlite3_value** argv);
+    static int suggestCommit(void* archive);
+    static void suggestRollback(void* archive);
+    
+    // Load every title and author into suggest_index, once
+    void buildSuggestIndex();
+    
+    // Lease a prepared statement on the writer connection (thread-safe)
+    StatementCache::Lease getPreparedStatement(const std::string& sql);
+    
+    // sqlite3_step, timed into the step histogram
+    int stepStatement(sqlite3_stmt* stmt);
+    
+    // sqlite3_busy_handler callback: sleep with jittered exponential backoff
+    // until the policy's timeout is used up
+    static int busyHandler(void* policy, int attempt);
+    
+    // BEGIN IMMEDIATE under lock (which holds db_mutex), so writers take the write
+    // lock up front instead of failing to upgrade a read lock mid-transaction.
+    // While another process holds the lock, db_mutex is released during each backoff.
+    bool beginImmediate(std::unique_lock<std::shared_mutex>& lock);
+    
+    // Print the stats command's report
+    void printStats();
+    
+    // Execute a parameterless statement (BEGIN/COMMIT/...), caller must hold db_mutex
+    bool executeRawSQL(const char* sql);
+    
+    // With bulk_imports set, run the writer on the bulk-load settings for the
+    // length of an import. beginBulkLoad returns whether endBulkLoad has to restore.
+    bool beginBulkLoad();
+    void endBulkLoad(bool active);
+    
+    // Print the settings SQLite is actually using, for version
+    void printDatabaseSettings();
+    
+    // Neither a snapshot nor opened read-only
+    bool writable() const { return !snapshot_mode && !config.read_only; }
+    
+    // Report and refuse a write in snapshot or read-only mode, true if the write must not go ahead
+    bool rejectWrite(const char* operation);
+    
+    // Cursor over the mapped snapshot: page bounds, plus an optional case-insensitive
+    // substring, or an exact author name when exact_author is set
+    Cursor snapshotCursor(const PageOptions& page, std::string_view keyword, bool exact_author = false);
+    
+    // searchBooks worker: match keywords[first], keywords[first + stride], ...
+    // with one FTS query and at most one scan, appending matches in id order
+    void searchPartition(const std::vector<std::string>& keywords, size_t first, size_t stride,
+                         BookResults& found);
+    
+    // searchBooks and unpaged searchBook in snapshot mode: the records split
+    // into id-ordered chunks, one thread per chunk, each matching every keyword
+    BookResults searchSnapshot(const std::vector<std::string>& keywords);
+    
+    // Insert a run of books inside one explicit transaction, returns rows inserted
+    size_t insertBookBatch(sqlite3_stmt* stmt, const Book* books, size_t count, size_t& failed);
+    
+    // Run work in its own BEGIN IMMEDIATE ... COMMIT on the writer connection,
+    // rolling back if it returns false. db_mutex is released afterwards, so
+    // other readers and writers get a turn between the chunks of a bulk write.
+    bool writeChunk(const std::function<bool()>& work);
 
 public:
     BookArchive(const std::string& db_file = "book_archive.db", LogLevel log_level = 
@@ -91,6 +363,18 @@ public:
         #else
             LogLevel::ERROR
         #endif
+        , size_t read_connections = DEFAULT_READ_CONNECTIONS
+        , const DatabaseConfig& config = DatabaseConfig()
+    );
+    
+    // Serve a snapshot read-only: searches, lookups, display and export work,
+    // writes are refused
+    explicit BookArchive(const SnapshotFile& snapshot_file, LogLevel log_level = 
+        #ifdef DEBUG_MODE
+            LogLevel::DEBUG
+        #else
+            LogLevel::ERROR
+        #endif
     );
     ~BookArchive();
     
@@ -100,27 +384,217 @@ public:
     BookArchive(BookArchive&&) = delete;
     BookArchive& operator=(BookArchive&&) = delete;
     
-    // Display all books
-    void displayBooks();
+    // One page of books in id order (all books by default)
+    BookResults listBooks(const PageOptions& page = {});
+    
+    // Stream books in id order / books matching keyword. Unpaged searches are
+    // ranked by relevance, paged ones are ordered by id so pages stay stable.
+    Cursor streamBooks(const PageOptions& page = {});
+    Cursor streamSearch(const std::string& keyword, const PageOptions& page = {});
+    
+    // Stream the books of one author (exact name) in id order, through the author_id index
+    Cursor streamBooksByAuthor(const std::string& author, const PageOptions& page = {});
     
     // Help and version info
     void help();
     void version();
     
     // CRUD operations
-    bool addBook(int id, const std::string& title, const std::string& author);
+    bool addBook(int id, std::string_view title, std::string_view author);
     bool deleteBook(int id);
-    bool updateBook(int id, const std::string& newTitle, const std::string& newAuthor);
-    std::vector<Book> searchBook(const std::string& keyword);
+    std::optional<Book> getBook(int id);  // Served from the cache when possible
+    bool updateBook(int id, std::string_view newTitle, std::string_view newAuthor);
+    BookResults searchBook(const std::string& keyword, const PageOptions& page = {});  // Served from the cache when possible
+    BookResults booksByAuthor(const std::string& author, const PageOptions& page = {});
+    
+    // Books matching any of keywords, deduplicated and in id order. Keywords are
+    // split across the read connections and searched in parallel. Nothing is printed.
+    BookResults searchBooks(const std::vector<std::string>& keywords);
+    
+    // Asynchronous writes, resolved once the change is committed. Concurrent
+    // writes are committed together; nothing is printed.
+    std::future<bool> addBookAsync(int id, std::string title, std::string author);
+    std::future<bool> deleteBookAsync(int id);
+    std::future<bool> updateBookAsync(int id, std::string newTitle, std::string newAuthor);
+    
+    // Asynchronous reads, run on the query executor. Up to one read per read
+    // connection runs at once, the rest queue; nothing is printed.
+    std::future<std::optional<Book>> getBookAsync(int id);
+    std::future<BookResults> listBooksAsync(PageOptions page = {});
+    std::future<BookResults> searchBookAsync(std::string keyword, PageOptions page = {});
+    std::future<BookResults> booksByAuthorAsync(std::string author, PageOptions page = {});
+    std::future<BookResults> searchBooksAsync(std::vector<std::string> keywords);
+    
+    // Run task on a query worker, for callers that continue from a callback or a
+    // coroutine (see ArchiveAwait.h) rather than wait on a future. False once the
+    // archive is shutting down; task is then dropped.
+    bool post(std::function<void(BookArchive&)> task);
+    
+    // Bulk operations: rows are committed in transactions of batch_size rows
+    size_t addBooks(const std::vector<Book>& books, size_t batch_size = IMPORT_BATCH_SIZE);
+    size_t importBooks(const std::string& filename, size_t batch_size = IMPORT_BATCH_SIZE);
+    
+    // Bulk deletes and updates, batch_size rows per transaction. They return the
+    // number of books deleted or updated; ids that do not exist are skipped.
+    size_t deleteBooks(const std::vector<int>& ids, size_t batch_size = IMPORT_BATCH_SIZE);
+    size_t deleteRange(int lo, int hi, size_t batch_size = IMPORT_BATCH_SIZE);  // lo <= id <= hi
+    size_t updateBooks(const std::vector<Book>& books, size_t batch_size = IMPORT_BATCH_SIZE);
+    
+    // Incremental sync: changes with a seq above seq, at most limit of them
+    // (0 = all). Start from 0 with an empty replica. Nothing is printed.
+    ChangeFeed changesSince(int64_t seq, size_t limit = CHANGE_FEED_PAGE_SIZE);
+    
+    // Forget deletions older than CHANGE_TOMBSTONE_DAYS; runs on open and after
+    // bulk deletes. Returns the number of log entries removed.
+    size_t compactChanges();
+    
+    // Titles and author names starting with prefix (ASCII case ignored), in
+    // alphabetical order, from memory. The first call builds the index.
+    std::vector<SuggestIndex::Suggestion> suggest(std::string_view prefix, size_t limit = SUGGEST_DEFAULT_LIMIT);
+    size_t exportBooks(const std::string& filename);
+    
+    // Write all books to a snapshot file / insert a snapshot's books into the database
+    size_t exportSnapshot(const std::string& filename);
+    size_t loadSnapshot(const std::string& filename, size_t batch_size = IMPORT_BATCH_SIZE);
+    
+    // Hit/miss counters of the getBook cache
+    BookCache::Counters bookCacheCounters() const;
+    
+    // Instrumentation counters and latency percentiles, plus the cache counters
+    StatsSnapshot statsSnapshot() const;
+    void resetStats();
     
     // Set log level dynamically
     void setLogLevel(LogLevel level);
     
+    // Default format of the listing commands; set it before running commands
+    void setOutputFormat(OutputFormat format);
+    
+    // Run one command, writing its output to out instead of std::cout.
+    // Safe to call from several threads at once.
+    void executeCommand(const std::string& command, std::ostream& out);
+    
     // Main command loop
     void run();
+    
+    // Non-interactive loop: no prompt or banner, buffered output, and runs of
+    // up to group_size consecutive add/update/delete commands share one transaction
+    void runBatch(std::istream& input, size_t group_size = 1);
+};
+
+// Forward-only cursor over a query's rows, one sqlite3_step at a time.
+// Holds its connection (or the writer lock) until exhausted or destroyed,
+// so do not write to the archive on the same thread while iterating.
+class BookArchive::Cursor {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = BookView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const BookView*;
+        using reference = const BookView&;
+        
+        explicit iterator(Cursor* cursor = nullptr) : cursor(cursor) {}
+        reference operator*() const { return cursor->current(); }
+        pointer operator->() const { return &cursor->current(); }
+        iterator& operator++() {
+            if (!cursor->next()) {
+                cursor = nullptr;
+            }
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return cursor == other.cursor; }
+        bool operator!=(const iterator& other) const { return cursor != other.cursor; }
+        
+    private:
+        Cursor* cursor;
+    };
+    
+    Cursor() = default;
+    Cursor(Cursor&& other) noexcept { *this = std::move(other); }
+    Cursor& operator=(Cursor&& other) noexcept;
+    
+    // Advance to the next row, false once the rows are exhausted or on error
+    bool next();
+    
+    const BookView& current() const { return row; }
+    
+    // Columns of the current row after id, title and author (statements only)
+    int64_t columnInt(int index) const;
+    std::string_view columnText(int index) const;
+    size_t rowCount() const { return rows; }
+    bool failed() const { return error; }
+    
+    iterator begin() { return next() ? iterator(this) : iterator(); }
+    iterator end() { return iterator(); }
+    
+private:
+    friend class BookArchive;
+    
+    // Return the statement before the connection or lock guarding it
+    void finish();
+    
+    BookArchive* owner = nullptr;
+    ConnectionPool::Lease conn;
+    std::unique_lock<std::shared_mutex> writer_lock;
+    StatementCache::Lease stmt;  // Declared last so it is released first
+    sqlite3* handle = nullptr;
+    BookView row{0, {}, {}};
+    size_t rows = 0;
+    bool error = false;
+    
+    // Snapshot mode: rows come from the mapped file instead of a statement
+    const BookSnapshot* source = nullptr;
+    size_t source_index = 0;
+    size_t source_end = 0;
+    size_t source_remaining = 0;
+    TextScan source_scan;       // Substring of the title or author, empty = every book
+    std::string source_author;  // Exact author name instead, when source_exact is set
+    bool source_exact = false;
 };
 
-// LogLevel to string conversion
-std::string logLevelToString(LogLevel level);
+template <typename Tuple>
+int BookArchive::bindTuple(sqlite3_stmt* stmt, const void* args, sqlite3_destructor_type lifetime) {
+    return std::apply([stmt, lifetime](const auto&... values) {
+        return sqlbind::bindAllWith(stmt, lifetime, values...);
+    }, *static_cast<const Tuple*>(args));
+}
+
+template <typename... Args>
+bool BookArchive::execute(const std::string& sql, const Args&... args) {
+    const std::tuple<const Args&...> bound(args...);
+    return executeBound(sql, &bindTuple<std::tuple<const Args&...>>, &bound);
+}
+
+template <typename Fn>
+auto BookArchive::submitRead(Fn read) -> std::future<decltype(read())> {
+    // std::function needs a copyable target, so the task is shared
+    auto task = std::make_shared<std::packaged_task<decltype(read())()>>(std::move(read));
+    auto result = task->get_future();
+    
+    // Refused while shutting down: the task is dropped unrun, and the future
+    // reports std::future_errc::broken_promise
+    query_executor.submit([task] { (*task)(); });
+    return result;
+}
+
+template <typename... Args>
+std::vector<Book> BookArchive::query(const std::string& sql, const Args&... args) {
+    const std::tuple<const Args&...> bound(args...);
+    return queryBound(sql, &bindTuple<std::tuple<const Args&...>>, &bound);
+}
+
+template <typename... Args>
+BookArchive::Cursor BookArchive::cursor(const std::string& sql, const Args&... args) {
+    const std::tuple<const Args&...> bound(args...);
+    return cursorBound(sql, &bindTuple<std::tuple<const Args&...>>, &bound, SQLITE_TRANSIENT);
+}
+
+template <typename... Args>
+std::optional<sqlite3_int64> BookArchive::queryInt(const std::string& sql, const Args&... args) {
+    const std::tuple<const Args&...> bound(args...);
+    return queryIntBound(sql, &bindTuple<std::tuple<const Args&...>>, &bound);
+}
 
 #endif // BOOK_ARCHIVE_H
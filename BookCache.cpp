@@ -0,0 +1,116 @@
+/**
+ * @file    BookCache.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the sharded book cache
+ */
+
+#include "BookCache.h"
+#include "BookArchive.h"
+
+// One independently locked slice of the cache, padded to its own cache lines
+struct alignas(64) BookCache::Shard {
+    std::mutex mutex;
+    std::list<Book> lru;  // Most recently used at the front
+    std::unordered_map<int, std::list<Book>::iterator> index;
+    uint64_t generation = 0;
+    size_t capacity = 0;
+};
+
+BookCache::BookCache(size_t capacity, size_t shard_count)
+    : shards(new Shard[shard_count > 0 ? shard_count : 1]), shard_count(shard_count > 0 ? shard_count : 1),
+      hits(0), misses(0), evictions(0), invalidations(0) {
+    size_t per_shard = (capacity + this->shard_count - 1) / this->shard_count;
+    for (size_t i = 0; i < this->shard_count; ++i) {
+        shards[i].capacity = per_shard > 0 ? per_shard : 1;
+    }
+}
+
+BookCache::~BookCache() = default;
+
+BookCache::Shard& BookCache::shardFor(int id) const {
+    // Mix the bits so sequential ids spread over every shard
+    uint32_t h = static_cast<uint32_t>(id) * 2654435761u;
+    return shards[(h >> 16) % shard_count];
+}
+
+bool BookCache::get(int id, Book& out, uint64_t& token) {
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(id);
+    if (it == shard.index.end()) {
+        token = shard.generation;
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    out = *it->second;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void BookCache::put(const Book& book, uint64_t token) {
+    Shard& shard = shardFor(book.id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // A write landed while the row was being loaded, so it may be stale
+    if (shard.generation != token) {
+        return;
+    }
+
+    auto it = shard.index.find(book.id);
+    if (it != shard.index.end()) {
+        *it->second = book;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    shard.lru.push_front(book);
+    shard.index.emplace(book.id, shard.lru.begin());
+
+    if (shard.lru.size() > shard.capacity) {
+        shard.index.erase(shard.lru.back().id);
+        shard.lru.pop_back();
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BookCache::invalidate(int id) {
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    shard.generation++;
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        invalidations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BookCache::clear() {
+    for (size_t i = 0; i < shard_count; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        shards[i].generation++;
+        shards[i].lru.clear();
+        shards[i].index.clear();
+    }
+}
+
+BookCache::Counters BookCache::counters() const {
+    Counters c;
+    c.hits = hits.load(std::memory_order_relaxed);
+    c.misses = misses.load(std::memory_order_relaxed);
+    c.evictions = evictions.load(std::memory_order_relaxed);
+    c.invalidations = invalidations.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        c.entries += shards[i].lru.size();
+    }
+    return c;
+}
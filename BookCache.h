@@ -0,0 +1,80 @@
+/**
+ * @file    BookCache.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Sharded, bounded LRU cache of books keyed by id
+ *
+ * @details Declares BookCache, the read-through cache behind
+ *          BookArchive::getBook. Ids are spread over independently locked
+ *          shards so concurrent lookups rarely contend. Every shard keeps
+ *          its own LRU list and a generation number that writers bump on
+ *          invalidation, which stops a reader from caching a row it loaded
+ *          before a concurrent update.
+ *
+ */
+
+#ifndef BOOK_CACHE_H
+#define BOOK_CACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#define BOOK_CACHE_CAPACITY 10000
+#define BOOK_CACHE_SHARDS 16
+
+struct Book;
+
+class BookCache {
+public:
+    // Cache effectiveness counters
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+    };
+
+    explicit BookCache(size_t capacity = BOOK_CACHE_CAPACITY, size_t shard_count = BOOK_CACHE_SHARDS);
+    ~BookCache();
+
+    BookCache(const BookCache&) = delete;
+    BookCache& operator=(const BookCache&) = delete;
+
+    // Copy the cached book into out. On a miss returns false and sets token,
+    // which must be passed to put() once the book has been loaded.
+    bool get(int id, Book& out, uint64_t& token);
+
+    // Cache a book loaded from the database, unless id was invalidated since the token was taken
+    void put(const Book& book, uint64_t token);
+
+    // Drop id after a write to it
+    void invalidate(int id);
+
+    // Drop everything (bulk writes)
+    void clear();
+
+    Counters counters() const;
+
+private:
+    struct Shard;
+
+    Shard& shardFor(int id) const;
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shard_count;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> invalidations;
+};
+
+#endif // BOOK_CACHE_H
@@ -0,0 +1,128 @@
+/**
+ * @file    BookResults.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the arena-backed result set
+ *
+ * @details Strings are carved out of a monotonic buffer resource and never
+ *          freed one by one. Author names go through a small open-addressing
+ *          table of the names already in the arena, sized to stay at most
+ *          half full, so each distinct name is copied once.
+ */
+
+#include "BookResults.h"
+#include <memory_resource>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+
+struct BookResults::Arena {
+    std::pmr::monotonic_buffer_resource memory{BOOK_RESULTS_BLOCK_SIZE};
+    std::vector<uint32_t> slots = std::vector<uint32_t>(64, 0);  // Index + 1 into authors, 0 = free
+    std::vector<std::string_view> authors;
+    size_t bytes = 0;  // Handed out by memory
+
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        char* data = static_cast<char*>(memory.allocate(text.size(), 1));
+        bytes += text.size();
+        std::memcpy(data, text.data(), text.size());
+        return {data, text.size()};
+    }
+
+    std::string_view intern(std::string_view author) {
+        size_t mask = slots.size() - 1;
+        size_t slot = std::hash<std::string_view>()(author) & mask;
+        while (slots[slot] != 0) {
+            if (authors[slots[slot] - 1] == author) {
+                return authors[slots[slot] - 1];
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        authors.push_back(copy(author));
+        slots[slot] = static_cast<uint32_t>(authors.size());
+        if (authors.size() * 2 > slots.size()) {
+            rehash(slots.size() * 2);
+        }
+        return authors.back();
+    }
+
+    void rehash(size_t size) {
+        slots.assign(size, 0);
+        for (size_t i = 0; i < authors.size(); ++i) {
+            size_t slot = std::hash<std::string_view>()(authors[i]) & (size - 1);
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (size - 1);
+            }
+            slots[slot] = static_cast<uint32_t>(i + 1);
+        }
+    }
+};
+
+BookResults::BookResults() = default;
+BookResults::~BookResults() = default;
+BookResults::BookResults(BookResults&&) noexcept = default;
+BookResults& BookResults::operator=(BookResults&&) noexcept = default;
+
+void BookResults::reserve(size_t count) {
+    rows.reserve(rows.size() + count);
+}
+
+void BookResults::add(int id, std::string_view title, std::string_view author) {
+    if (!arena) {
+        arena = std::make_shared<Arena>();
+    }
+    rows.push_back(BookView{id, arena->copy(title), arena->intern(author)});
+}
+
+void BookResults::append(BookResults&& other) {
+    if (rows.empty() && adopted.empty() && !arena) {
+        *this = std::move(other);
+        return;
+    }
+    rows.insert(rows.end(), other.rows.begin(), other.rows.end());
+    if (other.arena) {
+        adopted.push_back(std::move(other.arena));
+    }
+    std::move(other.adopted.begin(), other.adopted.end(), std::back_inserter(adopted));
+    other.rows.clear();
+    other.adopted.clear();
+}
+
+void BookResults::sortById() {
+    std::sort(rows.begin(), rows.end(), [](const BookView& a, const BookView& b) { return a.id < b.id; });
+    rows.erase(std::unique(rows.begin(), rows.end(),
+                           [](const BookView& a, const BookView& b) { return a.id == b.id; }), rows.end());
+}
+
+BookResults BookResults::share() const {
+    BookResults copy;
+    copy.rows = rows;
+    copy.adopted = adopted;
+    if (arena) {
+        copy.adopted.push_back(arena);  // Read only: the copy adds to an arena of its own
+    }
+    return copy;
+}
+
+size_t BookResults::memoryBytes() const {
+    size_t total = sizeof(*this) + rows.capacity() * sizeof(BookView);
+    auto count = [&total](const Arena& held) {
+        total += sizeof(Arena) + held.bytes + held.slots.capacity() * sizeof(uint32_t) +
+                 held.authors.capacity() * sizeof(std::string_view);
+    };
+    if (arena) {
+        count(*arena);
+    }
+    for (const std::shared_ptr<Arena>& held : adopted) {
+        count(*held);
+    }
+    return total;
+}
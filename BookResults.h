@@ -0,0 +1,105 @@
+/**
+ * @file    BookResults.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Book records and arena-backed result sets
+ *
+ * @details Defines Book, the owning record, BookView, a row seen through
+ *          string views, and BookResults, the result set returned by the
+ *          listing and search calls of BookArchive. A Book holds its own
+ *          title string; a result set of 100000 Books is 100000 allocations
+ *          and as many frees. BookResults instead copies every row's strings
+ *          into one monotonic arena (std::pmr::monotonic_buffer_resource)
+ *          and keeps the rows as BookViews into it, so filling it costs a
+ *          handful of block allocations and destroying it frees them in one
+ *          go. Author names are interned per result set: a name repeated on
+ *          many rows is stored once, without touching the process-wide
+ *          InternedString pool and its locks.
+ *
+ */
+
+#ifndef BOOK_RESULTS_H
+#define BOOK_RESULTS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "InternedString.h"
+
+#define BOOK_RESULTS_BLOCK_SIZE 16384   // First arena block; later blocks grow geometrically
+#define BOOK_RESULTS_MAX_RESERVE 65536  // Most rows reserved up front from a page limit
+
+// Simple book structure matching the book_rows view. Author names repeat
+// across many books, so every live Book with the same author shares one
+// string, freed with the last of them.
+struct Book {
+    int id;
+    std::string title;
+    InternedString author;
+};
+
+// A row seen through string views. From a cursor they point into SQLite's
+// column buffers and are only valid until the cursor advances; from a
+// BookResults they stay valid as long as the result set.
+struct BookView {
+    int id;
+    std::string_view title;
+    std::string_view author;
+
+    Book toBook() const { return Book{id, std::string(title), std::string(author)}; }
+};
+
+// Rows whose strings live in the result set's own arena. Moving hands over
+// the arena, so views taken from the rows stay valid; share() copies the rows
+// only, and the copies keep the arena alive between them.
+class BookResults {
+public:
+    using const_iterator = std::vector<BookView>::const_iterator;
+
+    BookResults();
+    ~BookResults();
+    BookResults(BookResults&&) noexcept;
+    BookResults& operator=(BookResults&&) noexcept;
+
+    BookResults(const BookResults&) = delete;
+    BookResults& operator=(const BookResults&) = delete;
+
+    // Room for that many more rows without regrowing
+    void reserve(size_t count);
+
+    // Copy a row into the arena
+    void add(int id, std::string_view title, std::string_view author);
+    void add(const BookView& book) { add(book.id, book.title, book.author); }
+
+    // Take over the rows of other along with its arena
+    void append(BookResults&& other);
+
+    // Sort the rows by id and drop repeated ids
+    void sortById();
+
+    // The same rows, viewing this result set's strings. Safe to take from
+    // several threads at once as long as nobody adds to this result set.
+    BookResults share() const;
+
+    // Heap memory held, roughly: the rows, the strings and the author tables
+    size_t memoryBytes() const;
+
+    size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    const BookView& operator[](size_t index) const { return rows[index]; }
+    const_iterator begin() const { return rows.begin(); }
+    const_iterator end() const { return rows.end(); }
+
+private:
+    struct Arena;
+
+    std::vector<BookView> rows;
+    std::shared_ptr<Arena> arena;                  // Created by the first add
+    std::vector<std::shared_ptr<Arena>> adopted;   // Arenas of appended or shared result sets
+};
+
+#endif // BOOK_RESULTS_H
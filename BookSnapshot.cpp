@@ -0,0 +1,203 @@
+/**
+ * @file    BookSnapshot.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of snapshot files
+ */
+
+#include "BookSnapshot.h"
+#include "BookArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+BookSnapshot::Writer::Writer(const std::string& filename) : filename(filename) {
+}
+
+bool BookSnapshot::Writer::intern(std::string_view text, uint32_t& offset, std::string& error) {
+    // Authors in particular repeat, so every distinct string is stored once
+    auto it = interned.find(std::string(text));
+    if (it != interned.end()) {
+        offset = it->second;
+        return true;
+    }
+
+    if (heap.size() + text.size() > std::numeric_limits<uint32_t>::max()) {
+        error = "Snapshot string heap exceeds 4 GiB";
+        return false;
+    }
+    offset = static_cast<uint32_t>(heap.size());
+    heap.append(text.data(), text.size());
+    interned.emplace(std::string(text), offset);
+    return true;
+}
+
+bool BookSnapshot::Writer::add(const BookView& book, std::string& error) {
+    if (!records.empty() && book.id <= records.back().id) {
+        error = "Snapshot books must be added in ascending id order";
+        return false;
+    }
+
+    SnapshotRecord record;
+    record.id = book.id;
+    record.title_length = static_cast<uint32_t>(book.title.size());
+    record.author_length = static_cast<uint32_t>(book.author.size());
+    if (!intern(book.title, record.title_offset, error) || !intern(book.author, record.author_offset, error)) {
+        return false;
+    }
+    records.push_back(record);
+    return true;
+}
+
+bool BookSnapshot::Writer::finish(std::string& error) {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_FORMAT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.book_count = records.size();
+    header.records_offset = sizeof(SnapshotHeader);
+    header.heap_offset = header.records_offset + records.size() * sizeof(SnapshotRecord);
+    header.heap_size = heap.size();
+    header.flags = SNAPSHOT_FLAG_SORTED;  // add() refuses ids out of order
+
+    // Readers never see a half-written snapshot under the final name
+    std::string temp = filename + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(SnapshotRecord)));
+        out.write(heap.data(), static_cast<std::streamsize>(heap.size()));
+        out.flush();
+        if (!out) {
+            error = "Cannot write snapshot file '" + temp + "'";
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(temp.c_str(), filename.c_str()) != 0) {
+        error = "Cannot replace snapshot file '" + filename + "': " + std::strerror(errno);
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+BookSnapshot::~BookSnapshot() {
+    close();
+}
+
+bool BookSnapshot::open(const std::string& filename, std::string& error) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Cannot open snapshot '" + filename + "': " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        error = "Snapshot '" + filename + "' is truncated";
+        return false;
+    }
+
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        error = "Cannot map snapshot '" + filename + "': " + std::strerror(errno);
+        return false;
+    }
+    base = static_cast<const char*>(mapping);
+    mapped_size = length;
+
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(base);
+    if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        error = "'" + filename + "' is not a book archive snapshot";
+    } else if (header->byte_order != SNAPSHOT_BYTE_ORDER) {
+        error = "Snapshot '" + filename + "' was written on a host with a different byte order";
+    } else if (header->version != SNAPSHOT_FORMAT_VERSION) {
+        error = "Snapshot '" + filename + "' has unsupported format version " + std::to_string(header->version);
+    } else if (header->records_offset % alignof(SnapshotRecord) != 0 ||
+               header->records_offset > length ||
+               header->book_count > (length - header->records_offset) / sizeof(SnapshotRecord) ||
+               header->heap_offset > length || header->heap_size > length - header->heap_offset) {
+        error = "Snapshot '" + filename + "' is truncated or corrupt";
+    }
+    if (!error.empty()) {
+        close();
+        return false;
+    }
+
+    records = reinterpret_cast<const SnapshotRecord*>(base + header->records_offset);
+    heap = base + header->heap_offset;
+    heap_size = header->heap_size;
+    count = static_cast<size_t>(header->book_count);
+
+    // Binary search needs sorted ids; older files do not say, so read them all once
+    if (!(header->flags & SNAPSHOT_FLAG_SORTED) && !verify(error)) {
+        error = "Snapshot '" + filename + "' is corrupt: " + error;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool BookSnapshot::verify(std::string& error) const {
+    for (size_t i = 0; i < count; ++i) {
+        const SnapshotRecord& r = records[i];
+        if (uint64_t(r.title_offset) + r.title_length > heap_size ||
+            uint64_t(r.author_offset) + r.author_length > heap_size ||
+            (i > 0 && r.id <= records[i - 1].id)) {
+            error = "record " + std::to_string(i) + " is out of order or points outside the heap";
+            return false;
+        }
+    }
+    return true;
+}
+
+void BookSnapshot::close() {
+    if (base) {
+        ::munmap(const_cast<char*>(base), mapped_size);
+    }
+    base = nullptr;
+    mapped_size = 0;
+    records = nullptr;
+    heap = nullptr;
+    heap_size = 0;
+    count = 0;
+}
+
+BookView BookSnapshot::at(size_t index) const {
+    const SnapshotRecord& r = records[index];
+    return BookView{r.id, heapString(r.title_offset, r.title_length), heapString(r.author_offset, r.author_length)};
+}
+
+size_t BookSnapshot::upperBound(int after_id) const {
+    const SnapshotRecord* end = records + count;
+    const SnapshotRecord* it = std::upper_bound(records, end, after_id,
+        [](int id, const SnapshotRecord& r) { return id < r.id; });
+    return static_cast<size_t>(it - records);
+}
+
+std::optional<BookView> BookSnapshot::find(int id) const {
+    const SnapshotRecord* end = records + count;
+    const SnapshotRecord* it = std::lower_bound(records, end, id,
+        [](const SnapshotRecord& r, int key) { return r.id < key; });
+    if (it != end && it->id == id) {
+        return at(static_cast<size_t>(it - records));
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file    BookSnapshot.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Compact, memory-mapped snapshot files of the archive
+ *
+ * @details Declares BookSnapshot, a read-only view of a snapshot file mapped
+ *          with mmap, and BookSnapshot::Writer, which produces one. A
+ *          snapshot is a fixed header, an array of fixed-width records
+ *          sorted by book id, and a heap holding every distinct title and
+ *          author string once:
+ *
+ *            offset 0               SnapshotHeader
+ *            records_offset         SnapshotRecord[book_count], by id
+ *            heap_offset            string bytes, referenced by offset/length
+ *
+ *          Numbers are stored in host byte order; the header records it and
+ *          files from a host of the other order are rejected.
+ *
+ *          Opening checks only the header, so start-up touches no record
+ *          pages. The writer flags the records as sorted, and every string
+ *          is bounds-checked on access; only files without the flag get a
+ *          full pass over the records, through verify().
+ *
+ */
+
+#ifndef BOOK_SNAPSHOT_H
+#define BOOK_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+#define SNAPSHOT_MAGIC "BKARSNAP"
+#define SNAPSHOT_FORMAT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_FLAG_SORTED 0x1u     // Written by Writer::finish: ids strictly ascending
+
+struct BookView;
+
+struct SnapshotHeader {
+    char magic[8];             // SNAPSHOT_MAGIC, not NUL terminated
+    uint32_t version;          // SNAPSHOT_FORMAT_VERSION
+    uint32_t byte_order;       // SNAPSHOT_BYTE_ORDER as written by the producer
+    uint64_t book_count;
+    uint64_t records_offset;
+    uint64_t heap_offset;
+    uint64_t heap_size;
+    uint64_t flags;            // SNAPSHOT_FLAG_*; zero in files from before the flags
+    uint64_t reserved[2];
+};
+
+struct SnapshotRecord {
+    int32_t id;
+    uint32_t title_offset;     // Into the heap
+    uint32_t title_length;
+    uint32_t author_offset;
+    uint32_t author_length;
+};
+
+class BookSnapshot {
+public:
+    // Builds a snapshot file from books added in ascending id order. Records
+    // and the string heap are held in memory until finish().
+    class Writer {
+    public:
+        explicit Writer(const std::string& filename);
+
+        // False (with error set) if ids are not strictly ascending or the heap is full
+        bool add(const BookView& book, std::string& error);
+
+        // Write the file next to its final name, then rename it into place
+        bool finish(std::string& error);
+
+        size_t size() const { return records.size(); }
+
+    private:
+        bool intern(std::string_view text, uint32_t& offset, std::string& error);
+
+        std::string filename;
+        std::vector<SnapshotRecord> records;
+        std::string heap;
+        std::unordered_map<std::string, uint32_t> interned;
+    };
+
+    BookSnapshot() = default;
+    ~BookSnapshot();
+
+    BookSnapshot(const BookSnapshot&) = delete;
+    BookSnapshot& operator=(const BookSnapshot&) = delete;
+
+    // Map a snapshot file and check its header. Records are only read here
+    // when the file lacks SNAPSHOT_FLAG_SORTED.
+    bool open(const std::string& filename, std::string& error);
+
+    // Read every record: ids strictly ascending, strings within the heap.
+    // False with error set at the first bad record.
+    bool verify(std::string& error) const;
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    size_t size() const { return count; }
+
+    // Book at index (0 <= index < size()); views point into the mapping. A
+    // string of a corrupt record that points outside the heap reads as empty.
+    BookView at(size_t index) const;
+
+    // Index of the first book with an id greater than after_id
+    size_t upperBound(int after_id) const;
+
+    std::optional<BookView> find(int id) const;
+
+private:
+    std::string_view heapString(uint32_t offset, uint32_t length) const {
+        return uint64_t(offset) + length <= heap_size ? std::string_view(heap + offset, length) : std::string_view();
+    }
+
+    const char* base = nullptr;
+    size_t mapped_size = 0;
+    const SnapshotRecord* records = nullptr;
+    const char* heap = nullptr;
+    uint64_t heap_size = 0;
+    size_t count = 0;
+};
+
+#endif // BOOK_SNAPSHOT_H
@@ -0,0 +1,99 @@
+/**
+ * @file    CommandTokenizer.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Allocation-free tokenizer for command lines
+ *
+ * @details Declares CommandTokenizer, which walks a command line as a
+ *          std::string_view: whitespace-separated tokens, the trimmed rest
+ *          of the line, and numbers parsed with std::from_chars. Nothing is
+ *          copied, so every view is only valid while the line it came from
+ *          is alive.
+ *
+ */
+
+#ifndef COMMAND_TOKENIZER_H
+#define COMMAND_TOKENIZER_H
+
+#include <string_view>
+#include <charconv>
+#include <type_traits>
+
+class CommandTokenizer {
+public:
+    explicit CommandTokenizer(std::string_view line) : line(line), pos(0) {}
+
+    // Next whitespace-separated token, empty once the line is used up
+    std::string_view next() {
+        skipSpace();
+        size_t start = pos;
+        while (pos < line.size() && !isSpace(line[pos])) {
+            pos++;
+        }
+        return line.substr(start, pos - start);
+    }
+
+    // The token next() would return, without consuming it
+    std::string_view peek() const {
+        CommandTokenizer copy = *this;
+        return copy.next();
+    }
+
+    // Everything left on the line, trimmed; consumes it
+    std::string_view rest() {
+        std::string_view remainder = trim(line.substr(pos));
+        pos = line.size();
+        return remainder;
+    }
+
+    bool atEnd() const { return peek().empty(); }
+
+    // Strip leading and trailing spaces and tabs (and a '\r' from CRLF input)
+    static std::string_view trim(std::string_view text) {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && isSpace(text[begin])) {
+            begin++;
+        }
+        while (end > begin && isSpace(text[end - 1])) {
+            end--;
+        }
+        return text.substr(begin, end - begin);
+    }
+
+    // Parse a whole token as a number; false if empty, malformed, out of
+    // range or followed by anything else. Unsigned targets reject a sign.
+    template <typename T>
+    static bool parseNumber(std::string_view token, T& value) {
+        static_assert(std::is_integral_v<T>, "parseNumber expects an integer type");
+        if (token.empty() || (std::is_unsigned_v<T> && token[0] == '-')) {
+            return false;
+        }
+        const char* first = token.data();
+        const char* last = token.data() + token.size();
+        if (*first == '+') {
+            first++;
+            if (first != last && *first == '-') {
+                return false;
+            }
+        }
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+
+private:
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    void skipSpace() {
+        while (pos < line.size() && isSpace(line[pos])) {
+            pos++;
+        }
+    }
+
+    std::string_view line;
+    size_t pos;
+};
+
+#endif // COMMAND_TOKENIZER_H
@@ -0,0 +1,138 @@
+/**
+ * @file    ConnectionPool.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the read connection pool
+ *
+ * @details Opens the read-only SQLite connections as they are needed,
+ *          prepares statements on them on demand, and hands connections out
+ *          to querying threads.
+ */
+
+#include "ConnectionPool.h"
+
+DbConnection::~DbConnection() {
+    statements.clear();
+
+    if (handle) {
+        sqlite3_close(handle);
+        handle = nullptr;
+    }
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        conn = other.conn;
+        other.pool = nullptr;
+        other.conn = nullptr;
+    }
+    return *this;
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool && conn) {
+        pool->release(conn);
+    }
+    pool = nullptr;
+    conn = nullptr;
+}
+
+ConnectionPool::~ConnectionPool() {
+    close();
+}
+
+bool ConnectionPool::open(const std::string& filename, size_t count, std::string& error,
+                          const std::function<void(sqlite3*)>& configure) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    this->filename = filename;
+    this->configure = configure;
+    capacity = count;
+
+    // One right away, so a file that cannot be opened fails here and not in a query
+    std::unique_ptr<DbConnection> conn = connect(error);
+    if (!conn) {
+        capacity = 0;
+        return false;
+    }
+    idle.push_back(conn.get());
+    connections.push_back(std::move(conn));
+    return true;
+}
+
+std::unique_ptr<DbConnection> ConnectionPool::connect(std::string& error) const {
+    auto conn = std::make_unique<DbConnection>();
+
+    // Each connection is leased to a single thread, so SQLite's own mutexes are not needed
+    int rc = sqlite3_open_v2(filename.c_str(), &conn->handle,
+                             SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (rc != SQLITE_OK) {
+        error = "Cannot open read connection: " + std::string(sqlite3_errmsg(conn->handle));
+        return nullptr;
+    }
+
+    sqlite3_exec(conn->handle, "PRAGMA temp_store = MEMORY;", nullptr, nullptr, nullptr);
+    if (configure) {
+        configure(conn->handle);
+    }
+    conn->statements.attach(conn->handle);
+    return conn;
+}
+
+void ConnectionPool::close() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    idle.clear();
+    connections.clear();
+    capacity = 0;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    if (idle.empty() && connections.size() + opening < capacity) {
+        // Opened without the mutex, so returned connections can be leased meanwhile
+        opening++;
+        lock.unlock();
+        std::string error;
+        std::unique_ptr<DbConnection> conn = connect(error);
+        lock.lock();
+        opening--;
+
+        if (conn) {
+            DbConnection* leased = conn.get();
+            connections.push_back(std::move(conn));
+            return Lease(this, leased);
+        }
+        // Make do with the connections that did open
+        capacity = connections.size() + opening;
+    }
+    available.wait(lock, [this] { return !idle.empty(); });
+
+    DbConnection* conn = idle.back();
+    idle.pop_back();
+    return Lease(this, conn);
+}
+
+void ConnectionPool::release(DbConnection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        idle.push_back(conn);
+    }
+    available.notify_one();
+}
+
+size_t ConnectionPool::size() const {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return connections.size();
+}
+
+StatementCache::Counters ConnectionPool::statementCounters() const {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    StatementCache::Counters total;
+    for (const auto& conn : connections) {
+        total += conn->statements.counters();
+    }
+    return total;
+}
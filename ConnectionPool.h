@@ -0,0 +1,114 @@
+/**
+ * @file    ConnectionPool.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Pool of read-only SQLite connections
+ *
+ * @details Declares DbConnection, a single SQLite handle together with the
+ *          cache of statements prepared on it, and ConnectionPool, which
+ *          hands out exclusive leases on a fixed set of read-only
+ *          connections so that queries can step in parallel on separate
+ *          threads. Only the first connection is opened up front; the
+ *          others are opened once every open one is leased at the same time,
+ *          so a short-lived process opens just the connections it uses.
+ *
+ */
+
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "StatementCache.h"
+
+// A database handle and its prepared statement cache
+struct DbConnection {
+    sqlite3* handle = nullptr;
+    StatementCache statements;
+
+    DbConnection() = default;
+    ~DbConnection();
+
+    DbConnection(const DbConnection&) = delete;
+    DbConnection& operator=(const DbConnection&) = delete;
+};
+
+class ConnectionPool {
+public:
+    // Exclusive use of one connection, returned to the pool on destruction
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(ConnectionPool* pool, DbConnection* conn) : pool(pool), conn(conn) {}
+        ~Lease() { release(); }
+
+        Lease(Lease&& other) noexcept : pool(other.pool), conn(other.conn) {
+            other.pool = nullptr;
+            other.conn = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept;
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        DbConnection* operator->() const { return conn; }
+        DbConnection& operator*() const { return *conn; }
+        explicit operator bool() const { return conn != nullptr; }
+
+    private:
+        void release();
+
+        ConnectionPool* pool = nullptr;
+        DbConnection* conn = nullptr;
+    };
+
+    ConnectionPool() = default;
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Allow up to `count` read-only connections to the database file and open
+    // the first, passing each new handle to configure (pragmas, busy handler)
+    // before it is used
+    bool open(const std::string& filename, size_t count, std::string& error,
+              const std::function<void(sqlite3*)>& configure = {});
+
+    // Close every connection, no leases may be outstanding
+    void close();
+
+    // Lease a free connection, opening another if all are leased and the
+    // pool is not full yet, or else block until one is returned
+    Lease acquire();
+
+    // Connections opened so far
+    size_t size() const;
+
+    // Statement cache counters summed over every connection
+    StatementCache::Counters statementCounters() const;
+
+private:
+    void release(DbConnection* conn);
+
+    // A new configured connection, or nullptr with error set
+    std::unique_ptr<DbConnection> connect(std::string& error) const;
+
+    std::string filename;
+    std::function<void(sqlite3*)> configure;
+    size_t capacity = 0;
+    size_t opening = 0;  // Being opened outside the mutex, counted against capacity
+
+    std::vector<std::unique_ptr<DbConnection>> connections;
+    std::vector<DbConnection*> idle;
+    mutable std::mutex pool_mutex;
+    std::condition_variable available;
+};
+
+#endif // CONNECTION_POOL_H
@@ -0,0 +1,245 @@
+/**
+ * @file    DatabaseConfig.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the database configuration profiles
+ */
+
+#include "DatabaseConfig.h"
+#include "CommandTokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+struct Profile {
+    const char* name;
+    const char* synchronous;
+    int64_t cache_size;
+    int64_t mmap_size;
+    int busy_timeout;
+    int wal_autocheckpoint;
+};
+
+const Profile profiles[] = {
+    {"balanced",   "NORMAL", -16384,  0,                 1000, 1000},
+    {"read-heavy", "NORMAL", -65536,  1024LL << 20,      1000, 1000},
+    {"bulk-load",  "OFF",    -262144, 256LL << 20,       1000, 10000},
+    {"durable",    "FULL",   -16384,  0,                 5000, 1000},
+};
+
+const Profile* findProfile(std::string_view name) {
+    for (const Profile& profile : profiles) {
+        if (name == profile.name) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+std::string upper(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return result;
+}
+
+bool oneOf(const std::string& value, std::initializer_list<const char*> choices) {
+    for (const char* choice : choices) {
+        if (value == choice) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "on"/"off" and the usual spellings of each
+bool parseFlag(std::string_view value, bool& flag) {
+    std::string text = upper(value);
+    if (oneOf(text, {"1", "ON", "TRUE", "YES"})) {
+        flag = true;
+    } else if (oneOf(text, {"0", "OFF", "FALSE", "NO"})) {
+        flag = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool DatabaseConfig::applyProfile(std::string_view name) {
+    const Profile* found = findProfile(name);
+    if (!found) {
+        return false;
+    }
+
+    *this = DatabaseConfig();
+    profile = found->name;
+    synchronous = found->synchronous;
+    cache_size = found->cache_size;
+    mmap_size = found->mmap_size;
+    busy_timeout = found->busy_timeout;
+    wal_autocheckpoint = found->wal_autocheckpoint;
+    return true;
+}
+
+bool DatabaseConfig::set(std::string_view key, std::string_view value, std::string& error) {
+    auto invalid = [&](const char* expected) {
+        error = "Invalid value '" + std::string(value) + "' for " + std::string(key) + " (expected " + expected + ")";
+        return false;
+    };
+
+    if (key == "profile") {
+        if (!applyProfile(value)) {
+            return invalid(("one of " + profileNames()).c_str());
+        }
+        return true;
+    }
+
+    if (key == "journal_mode") {
+        std::string mode = upper(value);
+        if (!oneOf(mode, {"WAL", "DELETE", "TRUNCATE", "PERSIST"})) {
+            return invalid("WAL, DELETE, TRUNCATE or PERSIST");
+        }
+        journal_mode = mode;
+    } else if (key == "synchronous") {
+        std::string level = upper(value);
+        if (!oneOf(level, {"OFF", "NORMAL", "FULL", "EXTRA"})) {
+            return invalid("OFF, NORMAL, FULL or EXTRA");
+        }
+        synchronous = level;
+    } else if (key == "cache_size") {
+        if (!CommandTokenizer::parseNumber(value, cache_size)) {
+            return invalid("pages, or -KiB");
+        }
+    } else if (key == "mmap_size") {
+        if (!CommandTokenizer::parseNumber(value, mmap_size) || mmap_size < 0) {
+            return invalid("bytes");
+        }
+    } else if (key == "busy_timeout") {
+        if (!CommandTokenizer::parseNumber(value, busy_timeout) || busy_timeout < 0) {
+            return invalid("milliseconds");
+        }
+    } else if (key == "page_size") {
+        int size = 0;
+        if (!CommandTokenizer::parseNumber(value, size) || size < 512 || size > 65536 || (size & (size - 1)) != 0) {
+            return invalid("a power of two from 512 to 65536");
+        }
+        page_size = size;
+    } else if (key == "wal_autocheckpoint") {
+        if (!CommandTokenizer::parseNumber(value, wal_autocheckpoint) || wal_autocheckpoint < 0) {
+            return invalid("pages");
+        }
+    } else if (key == "bulk_imports") {
+        if (!parseFlag(value, bulk_imports)) {
+            return invalid("on or off");
+        }
+    } else if (key == "read_only") {
+        if (!parseFlag(value, read_only)) {
+            return invalid("on or off");
+        }
+    } else {
+        error = "Unknown configuration key '" + std::string(key) + "'";
+        return false;
+    }
+
+    customized = true;
+    return true;
+}
+
+bool DatabaseConfig::loadFile(const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        error = "Cannot open config file '" + filename + "'";
+        return false;
+    }
+
+    // Collect first, so a profile line anywhere in the file is the base for the rest
+    std::vector<std::pair<std::string, std::string>> settings;
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(file, line)) {
+        lineNo++;
+        std::string_view text = line;
+        text = CommandTokenizer::trim(text.substr(0, text.find('#')));
+        if (text.empty()) {
+            continue;
+        }
+
+        size_t equals = text.find('=');
+        if (equals == std::string_view::npos) {
+            error = filename + ":" + std::to_string(lineNo) + ": expected key = value";
+            return false;
+        }
+        settings.emplace_back(std::string(CommandTokenizer::trim(text.substr(0, equals))),
+                              std::string(CommandTokenizer::trim(text.substr(equals + 1))));
+    }
+
+    for (const auto& setting : settings) {
+        if (setting.first == "profile" && !set(setting.first, setting.second, error)) {
+            error = filename + ": " + error;
+            return false;
+        }
+    }
+    for (const auto& setting : settings) {
+        if (setting.first != "profile" && !set(setting.first, setting.second, error)) {
+            error = filename + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> DatabaseConfig::writerPragmas() const {
+    // page_size has to come before the journal mode: a WAL database keeps its page size
+    return {
+        "PRAGMA page_size = " + std::to_string(page_size) + ";",
+        "PRAGMA journal_mode = " + journal_mode + ";",
+        "PRAGMA synchronous = " + synchronous + ";",
+        "PRAGMA cache_size = " + std::to_string(cache_size) + ";",
+        "PRAGMA mmap_size = " + std::to_string(mmap_size) + ";"
+    };
+}
+
+std::vector<std::string> DatabaseConfig::readerPragmas() const {
+    return {
+        "PRAGMA cache_size = " + std::to_string(cache_size) + ";",
+        "PRAGMA mmap_size = " + std::to_string(mmap_size) + ";"
+    };
+}
+
+const DatabaseConfig& DatabaseConfig::bulkLoadProfile() {
+    static const DatabaseConfig bulk = [] {
+        DatabaseConfig config;
+        config.applyProfile("bulk-load");
+        return config;
+    }();
+    return bulk;
+}
+
+std::vector<std::string> DatabaseConfig::bulkLoadPragmas() {
+    return bulkLoadProfile().restorePragmas();
+}
+
+std::vector<std::string> DatabaseConfig::restorePragmas() const {
+    return {
+        "PRAGMA synchronous = " + synchronous + ";",
+        "PRAGMA cache_size = " + std::to_string(cache_size) + ";"
+    };
+}
+
+std::string DatabaseConfig::profileNames() {
+    std::string names;
+    for (const Profile& profile : profiles) {
+        if (!names.empty()) {
+            names += ", ";
+        }
+        names += profile.name;
+    }
+    return names;
+}
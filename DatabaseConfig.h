@@ -0,0 +1,81 @@
+/**
+ * @file    DatabaseConfig.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   SQLite tuning settings and named configuration profiles
+ *
+ * @details Declares DatabaseConfig, the set of SQLite pragmas BookArchive
+ *          applies when it opens the database: journal mode, synchronous
+ *          level, page cache and mmap sizes, busy timeout, page size and
+ *          WAL auto-checkpoint interval. Settings start from a named
+ *          profile and can be overridden one by one, from a config file of
+ *          "key = value" lines or from the command line. The busy timeout
+ *          is enforced by BookArchive's own busy handler, not by PRAGMA
+ *          busy_timeout, and wal_autocheckpoint by its maintenance thread
+ *          (ArchiveMaintenance), not by PRAGMA wal_autocheckpoint.
+ *          With read_only set the writer connection is opened read-only
+ *          too and only gets the reader settings.
+ *
+ *          Profiles:
+ *            balanced    WAL, synchronous NORMAL, 16 MiB cache (the default)
+ *            read-heavy  64 MiB cache and a 1 GiB mmap for large archives
+ *            bulk-load   synchronous OFF, 256 MiB cache, rare checkpoints
+ *            durable     synchronous FULL and a long busy timeout
+ *
+ */
+
+#ifndef DATABASE_CONFIG_H
+#define DATABASE_CONFIG_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#define DEFAULT_DATABASE_PROFILE "balanced"
+
+struct DatabaseConfig {
+    std::string profile = DEFAULT_DATABASE_PROFILE;
+    bool customized = false;           // Some keys were overridden after the profile
+
+    std::string journal_mode = "WAL";
+    std::string synchronous = "NORMAL";
+    int64_t cache_size = -16384;       // PRAGMA cache_size units: pages, or KiB when negative
+    int64_t mmap_size = 0;             // Bytes, 0 = no memory-mapped I/O
+    int busy_timeout = 1000;           // Milliseconds to keep retrying a locked database, 0 = fail at once
+    int page_size = 4096;              // Only takes effect when the database is created
+    int wal_autocheckpoint = 1000;     // WAL pages that start a background checkpoint, 0 = never
+    bool bulk_imports = false;         // Switch to bulk-load settings around import/load-snapshot
+    bool read_only = false;            // Open an existing archive without writing to it at all
+
+    // Reset every setting to a named profile; false if the name is unknown
+    bool applyProfile(std::string_view name);
+
+    // Override one setting from text; false with a message on an unknown key or bad value
+    bool set(std::string_view key, std::string_view value, std::string& error);
+
+    // Read "key = value" lines ('#' starts a comment). A profile line selects
+    // the base profile; every other key overrides it, wherever it appears.
+    bool loadFile(const std::string& filename, std::string& error);
+
+    // Statements to run on the writer connection when it is opened, in order
+    std::vector<std::string> writerPragmas() const;
+
+    // Statements to run on each read-only connection
+    std::vector<std::string> readerPragmas() const;
+
+    // The bulk-load profile, for its checkpoint interval
+    static const DatabaseConfig& bulkLoadProfile();
+
+    // The settings of the bulk-load profile that differ per connection
+    // (synchronous, cache), and the ones to put back afterwards
+    static std::vector<std::string> bulkLoadPragmas();
+    std::vector<std::string> restorePragmas() const;
+
+    // "balanced, read-heavy, ..." for help and error messages
+    static std::string profileNames();
+};
+
+#endif // DATABASE_CONFIG_H
@@ -0,0 +1,95 @@
+/**
+ * @file    InternedString.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the reference-counted string intern pool
+ */
+
+#include "InternedString.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#define INTERN_POOL_SHARDS 16
+
+// One independently locked slice of the pool, padded to its own cache lines
+struct alignas(64) InternedString::Shard {
+    std::mutex mutex;
+    // Keys view the owned strings, so lookups by string_view never allocate
+    std::unordered_map<std::string_view, std::unique_ptr<Entry>> entries;
+};
+
+// Constructed on first use and never destroyed, so statics elsewhere can
+// hold interned strings until the very end of the process
+InternedString::Shard* InternedString::shards() {
+    static Shard* const pool = new Shard[INTERN_POOL_SHARDS];
+    return pool;
+}
+
+namespace {
+
+size_t shardIndex(std::string_view text) {
+    return std::hash<std::string_view>{}(text) % INTERN_POOL_SHARDS;
+}
+
+} // namespace
+
+InternedString::Entry* InternedString::emptyEntry() {
+    static Entry* const empty = new Entry{std::string(), {0}, false};
+    return empty;
+}
+
+InternedString::Entry* InternedString::acquire(std::string_view text) {
+    if (text.empty()) {
+        return emptyEntry();
+    }
+
+    Shard& shard = shards()[shardIndex(text)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(text);
+    if (it != shard.entries.end()) {
+        it->second->refs.fetch_add(1, std::memory_order_relaxed);
+        return it->second.get();
+    }
+
+    std::unique_ptr<Entry> owned(new Entry{std::string(text), {1}, true});
+    Entry* stored = owned.get();
+    shard.entries.emplace(std::string_view(stored->text), std::move(owned));
+    return stored;
+}
+
+void InternedString::release(Entry* entry) {
+    if (!entry->pooled) {
+        return;
+    }
+
+    // Other references remain: no need for the lock
+    size_t refs = entry->refs.load(std::memory_order_relaxed);
+    while (refs > 1) {
+        if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    // Possibly the last one. Under the lock nobody can find the entry again,
+    // and copies need a reference of their own, so reaching zero here is final.
+    Shard& shard = shards()[shardIndex(entry->text)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        shard.entries.erase(std::string_view(entry->text));
+    }
+}
+
+size_t InternedString::poolSize() {
+    size_t total = 0;
+    Shard* pool = shards();
+    for (size_t i = 0; i < INTERN_POOL_SHARDS; ++i) {
+        std::lock_guard<std::mutex> lock(pool[i].mutex);
+        total += pool[i].entries.size();
+    }
+    return total;
+}
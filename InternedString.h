@@ -0,0 +1,98 @@
+/**
+ * @file    InternedString.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Process-wide, reference-counted interning of repeated strings
+ *
+ * @details Declares InternedString, an immutable string whose characters
+ *          are stored once per process in a sharded pool. Book uses it for
+ *          author names: prolific authors appear on thousands of books, and
+ *          every cached or materialized copy shares one buffer instead of
+ *          holding its own. Copying bumps an atomic reference count and
+ *          equality is a pointer compare. An entry is freed with its last
+ *          reference, so the pool only holds the strings of live Books (the
+ *          book cache and result sets the caller keeps), however many
+ *          distinct authors pass through.
+ *
+ *          Interning a string takes its shard's lock; copies and moves do
+ *          not, and neither do the empty string and the default value.
+ *          Releasing takes the lock only when it may drop the last reference.
+ *
+ */
+
+#ifndef INTERNED_STRING_H
+#define INTERNED_STRING_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstddef>
+#include <atomic>
+#include <utility>
+
+class InternedString {
+public:
+    InternedString() : entry(emptyEntry()) {}
+    InternedString(std::string_view text) : entry(acquire(text)) {}
+    InternedString(const std::string& text) : entry(acquire(text)) {}
+    InternedString(const char* text) : entry(acquire(text)) {}
+
+    InternedString(const InternedString& other) : entry(other.entry) { retain(); }
+    InternedString(InternedString&& other) noexcept : entry(other.entry) { other.entry = emptyEntry(); }
+    InternedString& operator=(InternedString other) noexcept {
+        std::swap(entry, other.entry);
+        return *this;
+    }
+    ~InternedString() { release(entry); }
+
+    const std::string& str() const { return entry->text; }
+    operator const std::string&() const { return entry->text; }
+    operator std::string_view() const { return entry->text; }
+
+    bool empty() const { return entry->text.empty(); }
+    size_t size() const { return entry->text.size(); }
+
+    // Equal strings always share one pool entry while any of them is alive
+    friend bool operator==(const InternedString& a, const InternedString& b) { return a.entry == b.entry; }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return a.entry != b.entry; }
+
+    // Distinct strings alive in the pool
+    static size_t poolSize();
+
+private:
+    struct Entry {
+        std::string text;
+        std::atomic<size_t> refs;
+        bool pooled;  // False for the shared empty string, which is never counted or freed
+    };
+
+    struct Shard;
+
+    // The pool, in INTERN_POOL_SHARDS slices
+    static Shard* shards();
+
+    // The empty string, outside the pool
+    static Entry* emptyEntry();
+
+    // Pool entry for text with one more reference
+    static Entry* acquire(std::string_view text);
+
+    // Drop one reference, freeing the entry with the last
+    static void release(Entry* entry);
+
+    void retain() {
+        if (entry->pooled) {
+            entry->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Entry* entry;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const InternedString& text) {
+    return out << text.str();
+}
+
+#endif // INTERNED_STRING_H
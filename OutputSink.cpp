@@ -0,0 +1,318 @@
+/**
+ * @file    OutputSink.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the table, TSV and JSON-lines output sinks
+ */
+
+#include "OutputSink.h"
+#include <charconv>
+
+#define TABLE_ID_WIDTH 5
+#define TABLE_TITLE_WIDTH 30
+#define TABLE_AUTHOR_WIDTH 20
+#define TABLE_SEQ_WIDTH 10
+#define TABLE_OP_WIDTH 6
+#define TABLE_KIND_WIDTH 6
+#define TABLE_SUGGESTION_WIDTH 50
+
+namespace {
+
+class TableSink : public OutputSink {
+public:
+    using OutputSink::OutputSink;
+
+    void header() override {
+        headings();
+        appendRepeated('-', TABLE_ID_WIDTH + TABLE_TITLE_WIDTH + TABLE_AUTHOR_WIDTH + 5);
+        endLine();
+    }
+
+    void row(int id, std::string_view title, std::string_view author) override {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), id);
+        appendPadded(std::string_view(digits, result.ptr - digits), TABLE_ID_WIDTH);
+        append(" | ");
+        appendColumn(title, TABLE_TITLE_WIDTH);
+        append(" | ");
+        appendColumn(author, TABLE_AUTHOR_WIDTH);
+        endLine();
+    }
+
+    void changeHeader() override {
+        appendPadded("Seq", TABLE_SEQ_WIDTH);
+        append(" | ");
+        appendPadded("Op", TABLE_OP_WIDTH);
+        append(" | ");
+        headings();
+        appendRepeated('-', TABLE_SEQ_WIDTH + TABLE_OP_WIDTH + TABLE_ID_WIDTH + TABLE_TITLE_WIDTH + 
+                            TABLE_AUTHOR_WIDTH + 11);
+        endLine();
+    }
+
+    void changeRow(long long seq, std::string_view op, int id,
+                   std::string_view title, std::string_view author) override {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), seq);
+        appendPadded(std::string_view(digits, result.ptr - digits), TABLE_SEQ_WIDTH);
+        append(" | ");
+        appendPadded(op, TABLE_OP_WIDTH);
+        append(" | ");
+        row(id, title, author);
+    }
+
+    void suggestionHeader() override {
+        appendPadded("Kind", TABLE_KIND_WIDTH);
+        append(" | ");
+        appendPadded("Suggestion", TABLE_SUGGESTION_WIDTH);
+        append(" | ");
+        appendPadded("Books", TABLE_ID_WIDTH);
+        append('\n');
+        appendRepeated('-', TABLE_KIND_WIDTH + TABLE_SUGGESTION_WIDTH + TABLE_ID_WIDTH + 5);
+        endLine();
+    }
+
+    void suggestionRow(std::string_view kind, std::string_view text, unsigned books) override {
+        appendPadded(kind, TABLE_KIND_WIDTH);
+        append(" | ");
+        appendColumn(text, TABLE_SUGGESTION_WIDTH);
+        append(" | ");
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), books);
+        appendPadded(std::string_view(digits, result.ptr - digits), TABLE_ID_WIDTH);
+        endLine();
+    }
+
+private:
+    // The book column headings, shared by both tables
+    void headings() {
+        appendPadded("ID", TABLE_ID_WIDTH);
+        append(" | ");
+        appendPadded("Title", TABLE_TITLE_WIDTH);
+        append(" | ");
+        appendPadded("Author", TABLE_AUTHOR_WIDTH);
+        append('\n');
+    }
+
+    // Long values are cut to width - 3 characters plus "...", without a temporary string
+    void appendColumn(std::string_view value, size_t width) {
+        if (value.size() <= width) {
+            appendPadded(value, width);
+            return;
+        }
+        append(value.substr(0, width - 3));
+        append("...");
+    }
+};
+
+class TsvSink : public OutputSink {
+public:
+    using OutputSink::OutputSink;
+
+    void header() override {
+        append("id\ttitle\tauthor");
+        endLine();
+    }
+
+    void row(int id, std::string_view title, std::string_view author) override {
+        appendNumber(id);
+        append('\t');
+        appendField(title);
+        append('\t');
+        appendField(author);
+        endLine();
+    }
+
+    void changeHeader() override {
+        append("seq\top\tid\ttitle\tauthor");
+        endLine();
+    }
+
+    void changeRow(long long seq, std::string_view op, int id,
+                   std::string_view title, std::string_view author) override {
+        appendNumber(seq);
+        append('\t');
+        append(op);
+        append('\t');
+        row(id, title, author);
+    }
+
+    void suggestionHeader() override {
+        append("kind\ttext\tbooks");
+        endLine();
+    }
+
+    void suggestionRow(std::string_view kind, std::string_view text, unsigned books) override {
+        append(kind);
+        append('\t');
+        appendField(text);
+        append('\t');
+        appendNumber(books);
+        endLine();
+    }
+
+    void note(std::string_view) override {}
+
+private:
+    // Tabs, line breaks and backslashes are escaped so every row stays on one line
+    void appendField(std::string_view field) {
+        for (char c : field) {
+            switch (c) {
+                case '\t': append("\\t"); break;
+                case '\n': append("\\n"); break;
+                case '\r': append("\\r"); break;
+                case '\\': append("\\\\"); break;
+                default: append(c);
+            }
+        }
+    }
+};
+
+class JsonLinesSink : public OutputSink {
+public:
+    using OutputSink::OutputSink;
+
+    void header() override {}
+
+    void row(int id, std::string_view title, std::string_view author) override {
+        append("{\"id\":");
+        appendNumber(id);
+        append(",\"title\":");
+        appendString(title);
+        append(",\"author\":");
+        appendString(author);
+        append('}');
+        endLine();
+    }
+
+    void changeHeader() override {}
+
+    void changeRow(long long seq, std::string_view op, int id,
+                   std::string_view title, std::string_view author) override {
+        append("{\"seq\":");
+        appendNumber(seq);
+        append(",\"op\":");
+        appendString(op);
+        append(",\"id\":");
+        appendNumber(id);
+        if (op != "delete") {
+            append(",\"title\":");
+            appendString(title);
+            append(",\"author\":");
+            appendString(author);
+        }
+        append('}');
+        endLine();
+    }
+
+    void suggestionHeader() override {}
+
+    void suggestionRow(std::string_view kind, std::string_view text, unsigned books) override {
+        append("{\"kind\":");
+        appendString(kind);
+        append(",\"text\":");
+        appendString(text);
+        append(",\"books\":");
+        appendNumber(books);
+        append('}');
+        endLine();
+    }
+
+    void note(std::string_view) override {}
+
+private:
+    void appendString(std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+        append('"');
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                append('\\');
+                append(c);
+            } else if (c == '\n') {
+                append("\\n");
+            } else if (c == '\t') {
+                append("\\t");
+            } else if (byte < 0x20) {
+                append("\\u00");
+                append(hex[byte >> 4]);
+                append(hex[byte & 0xf]);
+            } else {
+                append(c);  // UTF-8 passes through unchanged
+            }
+        }
+        append('"');
+    }
+};
+
+} // namespace
+
+OutputSink::OutputSink(std::ostream& out) : out(out) {
+    buffer.reserve(OUTPUT_SINK_BUFFER_SIZE);
+}
+
+OutputSink::~OutputSink() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+}
+
+void OutputSink::note(std::string_view line) {
+    append(line);
+    endLine();
+}
+
+void OutputSink::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    out.flush();
+}
+
+std::unique_ptr<OutputSink> OutputSink::create(OutputFormat format, std::ostream& out) {
+    switch (format) {
+        case OutputFormat::TSV: return std::make_unique<TsvSink>(out);
+        case OutputFormat::JSON: return std::make_unique<JsonLinesSink>(out);
+        case OutputFormat::TABLE: break;
+    }
+    return std::make_unique<TableSink>(out);
+}
+
+bool OutputSink::parseFormat(std::string_view name, OutputFormat& format) {
+    if (name == "table") {
+        format = OutputFormat::TABLE;
+    } else if (name == "tsv") {
+        format = OutputFormat::TSV;
+    } else if (name == "json") {
+        format = OutputFormat::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void OutputSink::append(std::string_view text) {
+    buffer.append(text.data(), text.size());
+}
+
+void OutputSink::appendNumber(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr - digits);
+}
+
+void OutputSink::appendPadded(std::string_view text, size_t width) {
+    if (text.size() < width) {
+        buffer.append(width - text.size(), ' ');
+    }
+    append(text);
+}
+
+void OutputSink::endLine() {
+    buffer.push_back('\n');
+    if (buffer.size() >= OUTPUT_SINK_BUFFER_SIZE) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file    OutputSink.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Buffered writers for lists of books: table, TSV and JSON lines
+ *
+ * @details Declares OutputSink, the formatter the listing commands (get,
+ *          search, search-many, author, display, changes, suggest) print
+ *          through. Rows are formatted straight into one reusable buffer,
+ *          numbers with std::to_chars and long table columns truncated in
+ *          place, and the buffer is written to the stream only when it fills
+ *          up or the listing ends. The query methods themselves never print.
+ *
+ *          Formats:
+ *            table  The aligned, human-readable columns (the default)
+ *            tsv    An id/title/author header, then tab-separated rows
+ *            json   One {"id":..,"title":..,"author":..} object per line
+ *
+ *          Notes (titles, totals, paging hints) only appear in tables, so
+ *          TSV and JSON output can be piped straight into other tools.
+ *
+ */
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <memory>
+#include <cstddef>
+
+#define OUTPUT_SINK_BUFFER_SIZE 65536
+
+enum class OutputFormat {
+    TABLE,
+    TSV,
+    JSON
+};
+
+class OutputSink {
+public:
+    explicit OutputSink(std::ostream& out);
+    virtual ~OutputSink();  // Flushes whatever is still buffered
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // Column headings, once before the first row
+    virtual void header() = 0;
+
+    // One book
+    virtual void row(int id, std::string_view title, std::string_view author) = 0;
+
+    // The change feed instead of books: headings, then one entry per change.
+    // Deletes have no title or author.
+    virtual void changeHeader() = 0;
+    virtual void changeRow(long long seq, std::string_view op, int id,
+                           std::string_view title, std::string_view author) = 0;
+
+    // Typeahead completions instead of books: headings, then one title or author per row
+    virtual void suggestionHeader() = 0;
+    virtual void suggestionRow(std::string_view kind, std::string_view text, unsigned books) = 0;
+
+    // A line for people reading the output; dropped by machine-readable formats
+    virtual void note(std::string_view line);
+
+    // Write the buffer out and flush the stream
+    void flush();
+
+    // A sink writing format to out
+    static std::unique_ptr<OutputSink> create(OutputFormat format, std::ostream& out);
+
+    // "table", "tsv" or "json"; false if the name is unknown
+    static bool parseFormat(std::string_view name, OutputFormat& format);
+
+protected:
+    void append(std::string_view text);
+    void append(char c) { buffer.push_back(c); }
+    void appendNumber(long long value);
+    void appendPadded(std::string_view text, size_t width);  // Right-aligned, like std::setw
+    void appendRepeated(char c, size_t count) { buffer.append(count, c); }
+    void endLine();  // Ends a row, writing the buffer out once it is full
+
+private:
+    std::ostream& out;
+    std::string buffer;
+};
+
+#endif // OUTPUT_SINK_H
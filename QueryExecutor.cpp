@@ -0,0 +1,84 @@
+/**
+ * @file    QueryExecutor.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the query worker threads
+ */
+
+#include "QueryExecutor.h"
+#include <algorithm>
+
+QueryExecutor::~QueryExecutor() {
+    stop();
+}
+
+void QueryExecutor::configure(size_t threads) {
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_count = std::max<size_t>(1, threads);
+}
+
+bool QueryExecutor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return false;
+        }
+        if (workers.empty()) {
+            workers.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; ++i) {
+                workers.emplace_back(&QueryExecutor::run, this);
+            }
+        }
+        tasks.push_back(std::move(task));
+    }
+    ready.notify_one();
+    return true;
+}
+
+void QueryExecutor::stop() {
+    std::vector<std::thread> joining;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        joining.swap(workers);
+    }
+    ready.notify_all();
+    for (std::thread& worker : joining) {
+        worker.join();
+    }
+}
+
+QueryExecutor::Counters QueryExecutor::counters() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Counters counters;
+    counters.threads = workers.size();
+    counters.queued = tasks.size();
+    counters.completed = completed;
+    return counters;
+}
+
+void QueryExecutor::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;  // Stopping and drained
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (...) {
+            // Tasks report their own failures, through a promise or a callback
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        completed++;
+    }
+}
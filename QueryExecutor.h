@@ -0,0 +1,69 @@
+/**
+ * @file    QueryExecutor.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Worker threads behind the asynchronous read API
+ *
+ * @details Declares QueryExecutor, a fixed set of threads that run queued
+ *          tasks in order of submission. BookArchive sizes it to its read
+ *          connections, so every worker can hold a lease at once and none
+ *          waits on the pool, and hands it the reads of getBookAsync,
+ *          searchBookAsync and the rest. The threads start with the first
+ *          task, so archives that never read asynchronously never start
+ *          them. stop() runs whatever is still queued before joining, so
+ *          every submitted task runs exactly once.
+ *
+ */
+
+#ifndef QUERY_EXECUTOR_H
+#define QUERY_EXECUTOR_H
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+class QueryExecutor {
+public:
+    struct Counters {
+        size_t threads = 0;     // Started so far
+        size_t queued = 0;      // Waiting for a worker
+        uint64_t completed = 0;
+    };
+
+    QueryExecutor() = default;
+    ~QueryExecutor();
+
+    QueryExecutor(const QueryExecutor&) = delete;
+    QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+    // Number of workers to start with the first task (at least one)
+    void configure(size_t threads);
+
+    // Queue task for a worker. False once stop() has begun; task is then dropped.
+    // Exceptions escaping task are caught and discarded.
+    bool submit(std::function<void()> task);
+
+    // Run the queued tasks, then join the workers. Later submits fail.
+    void stop();
+
+    Counters counters() const;
+
+private:
+    void run();
+
+    mutable std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    size_t thread_count = 1;
+    uint64_t completed = 0;
+    bool stopping = false;
+};
+
+#endif // QUERY_EXECUTOR_H
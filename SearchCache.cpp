@@ -0,0 +1,101 @@
+/**
+ * @file    SearchCache.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the search result cache
+ */
+
+#include "SearchCache.h"
+
+SearchCache::SearchCache(size_t max_bytes, std::chrono::milliseconds ttl) : max_bytes(max_bytes), ttl(ttl) {}
+
+bool SearchCache::get(const std::string& key, BookResults& out, uint64_t& token) {
+    std::shared_ptr<const BookResults> found;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        token = generation.load(std::memory_order_acquire);
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            auto entry = it->second;
+            if (entry->generation != token) {
+                drop(entry, invalidations);
+            } else if (Clock::now() >= entry->expires) {
+                drop(entry, expirations);
+            } else {
+                lru.splice(lru.begin(), lru, entry);
+                found = entry->results;
+            }
+        }
+    }
+
+    if (!found) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Copying the rows can take a while; the shared pointer keeps them alive without the lock
+    out = found->share();
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void SearchCache::put(const std::string& key, const BookResults& results, uint64_t token) {
+    size_t size = key.size() + sizeof(Entry) + results.memoryBytes();
+    if (size > max_bytes / SEARCH_CACHE_ENTRY_SHARE) {
+        return;
+    }
+
+    // Share outside the lock, as in get()
+    auto shared = std::make_shared<const BookResults>(results.share());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // A write committed while the search ran, so it may have seen the old rows
+    if (generation.load(std::memory_order_acquire) != token) {
+        return;
+    }
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        bytes -= it->second->bytes;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    lru.push_front(Entry{key, std::move(shared), token, Clock::now() + ttl, size});
+    index.emplace(key, lru.begin());
+    bytes += size;
+
+    while (bytes > max_bytes) {
+        drop(std::prev(lru.end()), evictions);
+    }
+}
+
+void SearchCache::invalidate() {
+    generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+SearchCache::Counters SearchCache::counters() const {
+    Counters counters;
+    counters.hits = hits.load(std::memory_order_relaxed);
+    counters.misses = misses.load(std::memory_order_relaxed);
+    counters.expirations = expirations.load(std::memory_order_relaxed);
+    counters.evictions = evictions.load(std::memory_order_relaxed);
+    counters.invalidations = invalidations.load(std::memory_order_relaxed);
+    counters.generation = generation.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.entries = lru.size();
+    counters.bytes = bytes;
+    return counters;
+}
+
+void SearchCache::drop(std::list<Entry>::iterator entry, std::atomic<uint64_t>& counter) {
+    bytes -= entry->bytes;
+    index.erase(entry->key);
+    lru.erase(entry);
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
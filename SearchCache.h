@@ -0,0 +1,104 @@
+/**
+ * @file    SearchCache.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Bounded cache of keyword search results
+ *
+ * @details Declares SearchCache, the result cache behind
+ *          BookArchive::searchBook. Popular searches repeat far more often
+ *          than the archive changes, so their result sets are kept, keyed by
+ *          the normalized search and its page, in one LRU list bounded by
+ *          the memory the result sets hold. A hit hands out a BookResults
+ *          sharing the cached strings, so it copies only the rows.
+ *
+ *          Every committed write bumps a generation number, which makes
+ *          everything cached before it stale without touching the entries:
+ *          they are dropped when next looked up or when the LRU reaches
+ *          them. Entries also expire after a fixed time to live. As in
+ *          BookCache, a search that ran while a write committed is not
+ *          cached, since it may have seen the old rows.
+ *
+ */
+
+#ifndef SEARCH_CACHE_H
+#define SEARCH_CACHE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "BookResults.h"
+
+#define SEARCH_CACHE_BYTES (32 * 1024 * 1024)  // Memory the cached result sets may hold
+#define SEARCH_CACHE_TTL_MS 60000              // How long a result set may be served
+#define SEARCH_CACHE_ENTRY_SHARE 16            // No single result set takes more than 1/16 of the cache
+
+class SearchCache {
+public:
+    // Cache effectiveness counters
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t expirations = 0;   // Entries dropped after their time to live
+        uint64_t evictions = 0;     // Entries dropped to stay within the memory cap
+        uint64_t invalidations = 0; // Entries dropped because a write committed after them
+        uint64_t generation = 0;    // Writes seen so far
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit SearchCache(size_t max_bytes = SEARCH_CACHE_BYTES,
+                         std::chrono::milliseconds ttl = std::chrono::milliseconds(SEARCH_CACHE_TTL_MS));
+
+    SearchCache(const SearchCache&) = delete;
+    SearchCache& operator=(const SearchCache&) = delete;
+
+    // Share the cached results of key into out. On a miss returns false and
+    // sets token, which must be passed to put() once the results are loaded.
+    bool get(const std::string& key, BookResults& out, uint64_t& token);
+
+    // Cache results loaded for key, unless a write committed since the token was taken
+    void put(const std::string& key, const BookResults& results, uint64_t token);
+
+    // A write committed: everything cached so far is stale. Lock-free.
+    void invalidate();
+
+    Counters counters() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const BookResults> results;
+        uint64_t generation;
+        Clock::time_point expires;
+        size_t bytes;
+    };
+
+    // Unlink entry and count it against counter; caller holds the mutex
+    void drop(std::list<Entry>::iterator entry, std::atomic<uint64_t>& counter);
+
+    size_t max_bytes;
+    std::chrono::milliseconds ttl;
+
+    mutable std::mutex mutex;
+    std::list<Entry> lru;  // Most recently used at the front
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+
+    std::atomic<uint64_t> generation{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> expirations{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> invalidations{0};
+};
+
+#endif // SEARCH_CACHE_H
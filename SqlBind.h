@@ -0,0 +1,77 @@
+/**
+ * @file    SqlBind.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Compile-time typed parameter binding for SQLite statements
+ *
+ * @details Maps C++ argument types onto the matching sqlite3_bind_* call:
+ *          integers bind as INTEGER, floating point as REAL and anything
+ *          convertible to std::string_view as TEXT. Text is bound with
+ *          SQLITE_STATIC by default, so the caller's buffer is used in
+ *          place; this is safe because a statement lease clears its
+ *          bindings before the statement is reused. Statements that outlive
+ *          the call (cursors) bind with SQLITE_TRANSIENT instead.
+ *
+ */
+
+#ifndef SQL_BIND_H
+#define SQL_BIND_H
+
+#include <sqlite3.h>
+#include <string_view>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace sqlbind {
+
+// Text lifetime: SQLITE_STATIC uses the caller's buffer in place,
+// SQLITE_TRANSIENT makes SQLite copy it (for statements stepped later)
+inline int bindValue(sqlite3_stmt* stmt, int index, std::string_view value,
+                     sqlite3_destructor_type lifetime = SQLITE_STATIC) {
+    return sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), lifetime);
+}
+
+inline int bindValue(sqlite3_stmt* stmt, int index, std::nullptr_t,
+                     sqlite3_destructor_type = SQLITE_STATIC) {
+    return sqlite3_bind_null(stmt, index);
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_integral_v<T>, int>
+bindValue(sqlite3_stmt* stmt, int index, T value, sqlite3_destructor_type = SQLITE_STATIC) {
+    return sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(value));
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_floating_point_v<T>, int>
+bindValue(sqlite3_stmt* stmt, int index, T value, sqlite3_destructor_type = SQLITE_STATIC) {
+    return sqlite3_bind_double(stmt, index, static_cast<double>(value));
+}
+
+// Bind args to parameters 1..N, stopping at the first failure.
+// Returns SQLITE_OK or the failing sqlite3_bind_* result.
+template <typename... Args>
+inline int bindAllWith(sqlite3_stmt* stmt, sqlite3_destructor_type lifetime, const Args&... args) {
+    if constexpr (sizeof...(Args) == 0) {
+        (void)stmt;
+        (void)lifetime;
+        return SQLITE_OK;
+    }
+    int index = 0;
+    int rc = SQLITE_OK;
+    ((rc = (rc == SQLITE_OK ? bindValue(stmt, ++index, args, lifetime) : rc)), ...);
+    return rc;
+}
+
+// Bind args in place; they must stay alive until the statement is reset
+template <typename... Args>
+inline int bindAll(sqlite3_stmt* stmt, const Args&... args) {
+    return bindAllWith(stmt, SQLITE_STATIC, args...);
+}
+
+} // namespace sqlbind
+
+#endif // SQL_BIND_H
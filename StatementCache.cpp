@@ -0,0 +1,146 @@
+/**
+ * @file    StatementCache.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the leasing statement cache
+ *
+ * @details Statements are prepared outside the cache lock, handed out
+ *          through leases, and reset before they go back on the free-list
+ *          so that no bound buffer or read transaction outlives a lease.
+ */
+
+#include "StatementCache.h"
+
+StatementCache::Lease& StatementCache::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        cache = other.cache;
+        entry = std::move(other.entry);
+        stmt = other.stmt;
+        other.cache = nullptr;
+        other.stmt = nullptr;
+    }
+    return *this;
+}
+
+void StatementCache::Lease::release() {
+    if (cache && stmt) {
+        cache->release(entry, stmt);
+    }
+    cache = nullptr;
+    entry.reset();
+    stmt = nullptr;
+}
+
+StatementCache::Counters& StatementCache::Counters::operator+=(const Counters& other) {
+    hits += other.hits;
+    misses += other.misses;
+    prepares += other.prepares;
+    evictions += other.evictions;
+    return *this;
+}
+
+StatementCache::StatementCache(size_t capacity, size_t idle_per_key)
+    : handle(nullptr), capacity(capacity > 0 ? capacity : 1), idle_per_key(idle_per_key),
+      hits(0), misses(0), prepares(0), evictions(0) {
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+void StatementCache::attach(sqlite3* db) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    handle = db;
+}
+
+StatementCache::Lease StatementCache::acquire(const std::string& sql, std::string& error) {
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = entries.find(sql);
+        if (it != entries.end()) {
+            entry = it->second;
+            lru.splice(lru.begin(), lru, entry->lru_pos);
+
+            if (!entry->idle.empty()) {
+                sqlite3_stmt* stmt = entry->idle.back();
+                entry->idle.pop_back();
+                hits++;
+                return Lease(this, std::move(entry), stmt);
+            }
+        } else {
+            entry = std::make_shared<Entry>();
+            lru.push_front(sql);
+            entry->lru_pos = lru.begin();
+            entries.emplace(sql, entry);
+
+            // Keep the number of distinct statements bounded
+            while (entries.size() > capacity) {
+                evict(entries.find(lru.back()));
+            }
+        }
+        misses++;
+    }
+
+    // Every idle copy is in use, prepare another outside the lock
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(handle, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        error = "Failed to prepare statement: " + std::string(sqlite3_errmsg(handle)) + " for SQL: " + sql;
+        sqlite3_finalize(stmt);
+        return Lease();
+    }
+    prepares++;
+    return Lease(this, std::move(entry), stmt);
+}
+
+void StatementCache::release(const std::shared_ptr<Entry>& entry, sqlite3_stmt* stmt) {
+    // Drop bindings (they may point at caller buffers) and end any read transaction
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (!entry->evicted && entry->idle.size() < idle_per_key) {
+            entry->idle.push_back(stmt);
+            return;
+        }
+    }
+    sqlite3_finalize(stmt);
+}
+
+void StatementCache::evict(std::unordered_map<std::string, std::shared_ptr<Entry>>::iterator it) {
+    Entry& entry = *it->second;
+    entry.evicted = true;
+    for (sqlite3_stmt* stmt : entry.idle) {
+        sqlite3_finalize(stmt);
+    }
+    entry.idle.clear();
+    lru.erase(entry.lru_pos);
+    entries.erase(it);
+    evictions++;
+}
+
+void StatementCache::clear() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    for (auto& entry_pair : entries) {
+        entry_pair.second->evicted = true;
+        for (sqlite3_stmt* stmt : entry_pair.second->idle) {
+            sqlite3_finalize(stmt);
+        }
+        entry_pair.second->idle.clear();
+    }
+    entries.clear();
+    lru.clear();
+}
+
+StatementCache::Counters StatementCache::counters() const {
+    Counters c;
+    c.hits = hits.load(std::memory_order_relaxed);
+    c.misses = misses.load(std::memory_order_relaxed);
+    c.prepares = prepares.load(std::memory_order_relaxed);
+    c.evictions = evictions.load(std::memory_order_relaxed);
+    return c;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file    StatementCache.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Leasing cache of prepared SQLite statements
+ *
+ * @details Declares StatementCache, which keeps a small free-list of
+ *          prepared statements for every SQL string on one connection.
+ *          Callers check a statement out with an RAII Lease, so no two
+ *          threads ever bind or step the same sqlite3_stmt. The number of
+ *          distinct SQL strings is bounded by an LRU policy.
+ *
+ */
+
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#define STATEMENT_CACHE_CAPACITY 64
+#define STATEMENT_CACHE_IDLE_PER_KEY 4
+
+class StatementCache {
+private:
+    // All statements prepared for one SQL string
+    struct Entry {
+        std::vector<sqlite3_stmt*> idle;
+        std::list<std::string>::iterator lru_pos;
+        bool evicted = false;
+    };
+
+public:
+    // Exclusive use of one prepared statement, returned to the cache on destruction
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(StatementCache* cache, std::shared_ptr<Entry> entry, sqlite3_stmt* stmt)
+            : cache(cache), entry(std::move(entry)), stmt(stmt) {}
+        ~Lease() { release(); }
+
+        Lease(Lease&& other) noexcept
+            : cache(other.cache), entry(std::move(other.entry)), stmt(other.stmt) {
+            other.cache = nullptr;
+            other.stmt = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept;
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        sqlite3_stmt* get() const { return stmt; }
+        explicit operator bool() const { return stmt != nullptr; }
+
+    private:
+        void release();
+
+        StatementCache* cache = nullptr;
+        std::shared_ptr<Entry> entry;
+        sqlite3_stmt* stmt = nullptr;
+    };
+
+    // Cache effectiveness counters
+    struct Counters {
+        uint64_t hits = 0;       // Idle statement reused
+        uint64_t misses = 0;     // No idle statement, a new one had to be prepared
+        uint64_t prepares = 0;   // Successful sqlite3_prepare_v2 calls
+        uint64_t evictions = 0;  // SQL strings dropped by the LRU bound
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    explicit StatementCache(size_t capacity = STATEMENT_CACHE_CAPACITY,
+                            size_t idle_per_key = STATEMENT_CACHE_IDLE_PER_KEY);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Connection that statements are prepared on
+    void attach(sqlite3* handle);
+
+    // Check out a statement for sql, preparing one if none is idle.
+    // Returns an empty lease and fills error when preparation fails.
+    Lease acquire(const std::string& sql, std::string& error);
+
+    // Finalize every idle statement, leased ones are finalized on return
+    void clear();
+
+    Counters counters() const;
+
+private:
+    void release(const std::shared_ptr<Entry>& entry, sqlite3_stmt* stmt);
+    void evict(std::unordered_map<std::string, std::shared_ptr<Entry>>::iterator it);
+
+    sqlite3* handle;
+    size_t capacity;
+    size_t idle_per_key;
+
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    std::list<std::string> lru;  // Most recently used SQL at the front
+    std::mutex cache_mutex;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> prepares;
+    std::atomic<uint64_t> evictions;
+};
+
+#endif // STATEMENT_CACHE_H
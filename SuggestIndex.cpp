@@ -0,0 +1,253 @@
+/**
+ * @file    SuggestIndex.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the typeahead prefix index
+ */
+
+#include "SuggestIndex.h"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+namespace {
+
+char foldChar(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string fold(std::string_view text) {
+    std::string folded(text);
+    std::transform(folded.begin(), folded.end(), folded.begin(), foldChar);
+    return folded;
+}
+
+void appendFolded(std::string& out, std::string_view text) {
+    size_t start = out.size();
+    out.append(text.data(), text.size());
+    std::transform(out.begin() + static_cast<std::ptrdiff_t>(start), out.end(),
+                   out.begin() + static_cast<std::ptrdiff_t>(start), foldChar);
+}
+
+// Entries sort by key, then kind, then the original text
+int compareEntries(std::string_view key_a, SuggestIndex::Kind kind_a, std::string_view text_a,
+                   std::string_view key_b, SuggestIndex::Kind kind_b, std::string_view text_b) {
+    if (int order = key_a.compare(key_b)) {
+        return order;
+    }
+    if (kind_a != kind_b) {
+        return kind_a < kind_b ? -1 : 1;
+    }
+    return text_a.compare(text_b);
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+void SuggestIndex::Builder::add(std::string_view title, std::string_view author) {
+    for (auto [value, kind] : {std::make_pair(title, Kind::TITLE), std::make_pair(author, Kind::AUTHOR)}) {
+        Pending entry{static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(value.size()), kind};
+        appendFolded(arena, value);
+        arena.append(value.data(), value.size());
+        pending.push_back(entry);
+    }
+}
+
+void SuggestIndex::replace(Builder& builder) {
+    const std::string& source = builder.arena;
+    auto keyOf = [&](const Builder::Pending& p) { return std::string_view(source.data() + p.offset, p.length); };
+    auto textOf = [&](const Builder::Pending& p) { return std::string_view(source.data() + p.offset + p.length, p.length); };
+
+    std::sort(builder.pending.begin(), builder.pending.end(), [&](const Builder::Pending& a, const Builder::Pending& b) {
+        return compareEntries(keyOf(a), a.kind, textOf(a), keyOf(b), b.kind, textOf(b)) < 0;
+    });
+
+    // Authors repeat once per book: keep one copy of each value, counting the books
+    std::string packed;
+    std::vector<Entry> sorted;
+    for (const Builder::Pending& p : builder.pending) {
+        if (!sorted.empty()) {
+            Entry& last = sorted.back();
+            std::string_view last_key(packed.data() + last.offset, last.length);
+            std::string_view last_text(packed.data() + last.offset + last.length, last.length);
+            if (last.kind == p.kind && last_key == keyOf(p) && last_text == textOf(p)) {
+                last.books++;
+                continue;
+            }
+        }
+        sorted.push_back(Entry{static_cast<uint32_t>(packed.size()), p.length, 1, p.kind});
+        packed.append(source.data() + p.offset, 2 * static_cast<size_t>(p.length));
+    }
+    packed.shrink_to_fit();
+    sorted.shrink_to_fit();
+    builder = Builder();
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    arena = std::move(packed);
+    entries = std::move(sorted);
+    delta.clear();
+    dead = 0;
+}
+
+SuggestIndex::Entry* SuggestIndex::findEntry(std::string_view folded, std::string_view value, Kind kind) {
+    auto it = std::lower_bound(entries.begin(), entries.end(), 0, [&](const Entry& entry, int) {
+        return compareEntries(key(entry), entry.kind, text(entry), folded, kind, value) < 0;
+    });
+    if (it != entries.end() && it->kind == kind && key(*it) == folded && text(*it) == value) {
+        return &*it;
+    }
+    return nullptr;
+}
+
+void SuggestIndex::apply(std::vector<Change>& changes) {
+    if (changes.empty()) {
+        return;
+    }
+
+    // Net book count change of each value the arena does not hold
+    struct Net {
+        std::string key;
+        std::string text;
+        Kind kind;
+        int64_t books;
+    };
+    std::vector<Net> outside;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (Change& change : changes) {
+        std::string folded = fold(change.text);
+        if (Entry* entry = findEntry(folded, change.text, change.kind)) {
+            if (change.added) {
+                if (entry->books++ == 0) {
+                    dead--;
+                }
+            } else if (entry->books > 0 && --entry->books == 0) {
+                dead++;
+            }
+            continue;
+        }
+        outside.push_back(Net{std::move(folded), std::move(change.text), change.kind, change.added ? 1 : -1});
+    }
+    changes.clear();
+
+    // One value per net change, then a single merge pass with the delta
+    auto less = [](const auto& a, const auto& b) {
+        return compareEntries(a.key, a.kind, a.text, b.key, b.kind, b.text) < 0;
+    };
+    std::sort(outside.begin(), outside.end(), less);
+
+    std::vector<DeltaEntry> merged;
+    merged.reserve(delta.size() + outside.size());
+    auto d = delta.begin();
+    for (size_t i = 0; i < outside.size();) {
+        Net& net = outside[i];
+        int64_t books = 0;
+        for (; i < outside.size() && !less(net, outside[i]); ++i) {
+            books += outside[i].books;
+        }
+        while (d != delta.end() && less(*d, net)) {
+            merged.push_back(std::move(*d++));
+        }
+        if (d != delta.end() && !less(net, *d)) {
+            books += d->books;
+            ++d;
+        }
+        if (books > 0) {
+            merged.push_back(DeltaEntry{std::move(net.key), std::move(net.text), static_cast<uint32_t>(books), net.kind});
+        }
+    }
+    std::move(d, delta.end(), std::back_inserter(merged));
+    delta = std::move(merged);
+
+    if (delta.size() >= SUGGEST_DELTA_LIMIT || dead > entries.size() / 4) {
+        merge();
+    }
+}
+
+std::vector<SuggestIndex::Suggestion> SuggestIndex::suggest(std::string_view prefix, size_t limit) const {
+    lookups.fetch_add(1, std::memory_order_relaxed);
+    std::string folded = fold(prefix);
+    std::vector<Suggestion> found;
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto e = std::lower_bound(entries.begin(), entries.end(), folded, [&](const Entry& entry, const std::string& k) {
+        return key(entry) < std::string_view(k);
+    });
+    auto d = std::lower_bound(delta.begin(), delta.end(), folded, [](const DeltaEntry& entry, const std::string& k) {
+        return entry.key < k;
+    });
+
+    // Both runs are in the same order, so merging them keeps the result sorted
+    while (found.size() < limit) {
+        bool from_entries = e != entries.end() && startsWith(key(*e), folded);
+        bool from_delta = d != delta.end() && startsWith(d->key, folded);
+        if (!from_entries && !from_delta) {
+            break;
+        }
+        if (from_entries && from_delta) {
+            from_entries = compareEntries(key(*e), e->kind, text(*e), d->key, d->kind, d->text) < 0;
+        }
+
+        if (from_entries) {
+            if (e->books > 0) {
+                found.push_back(Suggestion{std::string(text(*e)), e->kind, e->books});
+            }
+            ++e;
+        } else {
+            found.push_back(Suggestion{d->text, d->kind, d->books});
+            ++d;
+        }
+    }
+    return found;
+}
+
+SuggestIndex::Counters SuggestIndex::counters() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    Counters out;
+    out.entries = entries.size() + delta.size();
+    out.delta = delta.size();
+    out.bytes = arena.size();
+    out.lookups = lookups.load(std::memory_order_relaxed);
+    out.merges = merges.load(std::memory_order_relaxed);
+    return out;
+}
+
+void SuggestIndex::merge() {
+    std::string packed;
+    std::vector<Entry> sorted;
+    packed.reserve(arena.size());
+    sorted.reserve(entries.size() - dead + delta.size());
+
+    auto keep = [&](std::string_view k, std::string_view value, uint32_t books, Kind kind) {
+        sorted.push_back(Entry{static_cast<uint32_t>(packed.size()), static_cast<uint32_t>(k.size()), books, kind});
+        packed.append(k.data(), k.size());
+        packed.append(value.data(), value.size());
+    };
+
+    auto e = entries.begin();
+    auto d = delta.begin();
+    while (e != entries.end() || d != delta.end()) {
+        bool from_entries = d == delta.end() ||
+            (e != entries.end() && compareEntries(key(*e), e->kind, text(*e), d->key, d->kind, d->text) < 0);
+        if (from_entries) {
+            if (e->books > 0) {
+                keep(key(*e), text(*e), e->books, e->kind);
+            }
+            ++e;
+        } else {
+            keep(d->key, d->text, d->books, d->kind);
+            ++d;
+        }
+    }
+
+    arena = std::move(packed);
+    entries = std::move(sorted);
+    delta.clear();
+    dead = 0;
+    merges.fetch_add(1, std::memory_order_relaxed);
+}
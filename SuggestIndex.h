@@ -0,0 +1,131 @@
+/**
+ * @file    SuggestIndex.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   In-memory prefix index of titles and author names for typeahead
+ *
+ * @details Declares SuggestIndex, the sorted string array behind the suggest
+ *          command. Every distinct title and author name is stored once, as
+ *          its lowercase key followed by the original text, in one
+ *          contiguous arena; a parallel array of fixed-size entries sorted
+ *          by key is binary searched for the prefix and walked forward, so a
+ *          lookup touches a few cache lines and never SQLite. Each entry
+ *          counts the books using it.
+ *
+ *          Values added after the build go to a small sorted delta, and
+ *          entries whose count drops to zero stay as tombstones; both are
+ *          merged back into the arena once the delta fills up or a quarter
+ *          of the entries are dead.
+ *
+ */
+
+#ifndef SUGGEST_INDEX_H
+#define SUGGEST_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <shared_mutex>
+#include <atomic>
+#include <cstdint>
+
+#define SUGGEST_DEFAULT_LIMIT 10
+#define SUGGEST_MAX_LIMIT 1000
+#define SUGGEST_DELTA_LIMIT 16384  // Entries added since the last merge before they are merged in
+
+class SuggestIndex {
+public:
+    enum class Kind : uint8_t { TITLE, AUTHOR };
+
+    struct Suggestion {
+        std::string text;
+        Kind kind;
+        uint32_t books;  // Books with this title or by this author
+
+        const char* kindName() const { return kind == Kind::TITLE ? "title" : "author"; }
+    };
+
+    // One more (added) or one fewer book with this title or author
+    struct Change {
+        std::string text;
+        Kind kind;
+        bool added;
+    };
+
+    struct Counters {
+        size_t entries = 0;    // Distinct titles and authors, tombstones included
+        size_t delta = 0;      // Entries not merged into the arena yet
+        size_t bytes = 0;      // Arena size
+        uint64_t lookups = 0;
+        uint64_t merges = 0;
+    };
+
+    // Collects the books of the initial build, see replace()
+    class Builder {
+    public:
+        void add(std::string_view title, std::string_view author);
+
+    private:
+        friend class SuggestIndex;
+        struct Pending {
+            uint32_t offset;  // Key in arena, then the text
+            uint32_t length;
+            Kind kind;
+        };
+        std::string arena;
+        std::vector<Pending> pending;
+    };
+
+    SuggestIndex() = default;
+
+    SuggestIndex(const SuggestIndex&) = delete;
+    SuggestIndex& operator=(const SuggestIndex&) = delete;
+
+    // Swap in the contents of builder, dropping everything indexed before
+    void replace(Builder& builder);
+
+    // Apply the changes of one commit, in order. New values are sorted and
+    // merged into the delta in one pass. Clears changes.
+    void apply(std::vector<Change>& changes);
+
+    // Titles and authors starting with prefix, ignoring ASCII case, in key order
+    std::vector<Suggestion> suggest(std::string_view prefix, size_t limit) const;
+
+    Counters counters() const;
+
+private:
+    struct Entry {
+        uint32_t offset;  // Lowercase key in arena, followed by the original text
+        uint32_t length;  // Of each
+        uint32_t books;   // 0 = tombstone
+        Kind kind;
+    };
+    struct DeltaEntry {
+        std::string key;
+        std::string text;
+        uint32_t books;
+        Kind kind;
+    };
+
+    std::string_view key(const Entry& entry) const { return {arena.data() + entry.offset, entry.length}; }
+    std::string_view text(const Entry& entry) const { return {arena.data() + entry.offset + entry.length, entry.length}; }
+
+    // Entry exactly matching text and kind, or nullptr
+    Entry* findEntry(std::string_view folded, std::string_view text, Kind kind);
+
+    // Fold the delta into the arena and drop tombstones, caller holds the lock exclusively
+    void merge();
+
+    mutable std::shared_mutex mutex;
+    std::string arena;
+    std::vector<Entry> entries;     // Sorted by key, kind, text
+    std::vector<DeltaEntry> delta;  // Same order
+    size_t dead = 0;                // Entries with no books
+
+    mutable std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> merges{0};
+};
+
+#endif // SUGGEST_INDEX_H
@@ -0,0 +1,273 @@
+/**
+ * @file    TextScan.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Implementation of the substring kernels and their dispatch
+ *
+ * @details Every kernel looks for positions where the first and the last
+ *          byte of the needle both match, a block of positions at a time,
+ *          and compares the bytes in between only there. OR-ing 0x20 into a
+ *          text byte folds it when the needle byte is a letter: (c | 0x20)
+ *          equals 'a' exactly for 'a' and 'A'. Other needle bytes are
+ *          compared as they are. A text shorter than one block goes to the
+ *          scalar loop, and the tail of a longer one is covered by a last
+ *          block overlapping the one before, so no kernel reads outside the
+ *          text.
+ */
+
+#include "TextScan.h"
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXT_SCAN_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define TEXT_SCAN_NEON 1
+#endif
+
+namespace {
+
+struct Needle {
+    const char* data;
+    size_t size;
+    unsigned char first_case;
+    unsigned char last_case;
+};
+
+using Kernel = bool (*)(const char* text, size_t length, const Needle& needle);
+
+unsigned char foldChar(unsigned char c) {
+    return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+bool isLetter(unsigned char c) {
+    return static_cast<unsigned char>(foldChar(c) - 'a') < 26;
+}
+
+// text[0, length) equals the folded needle bytes, ignoring case
+bool equalsFolded(const char* text, const char* folded, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (foldChar(static_cast<unsigned char>(text[i])) != static_cast<unsigned char>(folded[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The bytes between the first and the last, once both matched at position
+bool middleMatches(const char* text, size_t position, const Needle& needle) {
+    return needle.size <= 2 || equalsFolded(text + position + 1, needle.data + 1, needle.size - 2);
+}
+
+bool scanScalar(const char* text, size_t length, const Needle& needle) {
+    const unsigned char first = static_cast<unsigned char>(needle.data[0]);
+    const unsigned char last = static_cast<unsigned char>(needle.data[needle.size - 1]);
+    for (size_t i = 0; i + needle.size <= length; ++i) {
+        if ((static_cast<unsigned char>(text[i]) | needle.first_case) == first &&
+            (static_cast<unsigned char>(text[i + needle.size - 1]) | needle.last_case) == last &&
+            middleMatches(text, i, needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef TEXT_SCAN_X86
+
+bool scanSse2(const char* text, size_t length, const Needle& needle) {
+    const size_t block = 16;
+    if (length < block + needle.size - 1) {
+        return scanScalar(text, length, needle);
+    }
+
+    const __m128i first = _mm_set1_epi8(needle.data[0]);
+    const __m128i last = _mm_set1_epi8(needle.data[needle.size - 1]);
+    const __m128i first_case = _mm_set1_epi8(static_cast<char>(needle.first_case));
+    const __m128i last_case = _mm_set1_epi8(static_cast<char>(needle.last_case));
+
+    // Candidates among the block positions starting at i
+    auto scanBlock = [&](size_t i) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + needle.size - 1));
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(head, first_case), first),
+                                     _mm_cmpeq_epi8(_mm_or_si128(tail, last_case), last));
+        for (unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(hits)); bits != 0; bits &= bits - 1) {
+            if (middleMatches(text, i + static_cast<size_t>(__builtin_ctz(bits)), needle)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const size_t positions = length - needle.size + 1;
+    size_t i = 0;
+    for (; i + block <= positions; i += block) {
+        if (scanBlock(i)) {
+            return true;
+        }
+    }
+    return i < positions && scanBlock(positions - block);
+}
+
+__attribute__((target("avx2")))
+bool scanAvx2(const char* text, size_t length, const Needle& needle) {
+    const size_t block = 32;
+    if (length < block + needle.size - 1) {
+        return scanSse2(text, length, needle);
+    }
+
+    const __m256i first = _mm256_set1_epi8(needle.data[0]);
+    const __m256i last = _mm256_set1_epi8(needle.data[needle.size - 1]);
+    const __m256i first_case = _mm256_set1_epi8(static_cast<char>(needle.first_case));
+    const __m256i last_case = _mm256_set1_epi8(static_cast<char>(needle.last_case));
+
+    auto scanBlock = [&](size_t i) __attribute__((target("avx2"))) {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + needle.size - 1));
+        __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(head, first_case), first),
+                                        _mm256_cmpeq_epi8(_mm256_or_si256(tail, last_case), last));
+        for (unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(hits)); bits != 0; bits &= bits - 1) {
+            if (middleMatches(text, i + static_cast<size_t>(__builtin_ctz(bits)), needle)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const size_t positions = length - needle.size + 1;
+    size_t i = 0;
+    for (; i + block <= positions; i += block) {
+        if (scanBlock(i)) {
+            return true;
+        }
+    }
+    return i < positions && scanBlock(positions - block);
+}
+
+bool hasAvx2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif // TEXT_SCAN_X86
+
+#ifdef TEXT_SCAN_NEON
+
+bool scanNeon(const char* text, size_t length, const Needle& needle) {
+    const size_t block = 16;
+    if (length < block + needle.size - 1) {
+        return scanScalar(text, length, needle);
+    }
+
+    const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(needle.data[0]));
+    const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(needle.data[needle.size - 1]));
+    const uint8x16_t first_case = vdupq_n_u8(needle.first_case);
+    const uint8x16_t last_case = vdupq_n_u8(needle.last_case);
+
+    auto scanBlock = [&](size_t i) {
+        uint8x16_t head = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i));
+        uint8x16_t tail = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i + needle.size - 1));
+        uint8x16_t hits = vandq_u8(vceqq_u8(vorrq_u8(head, first_case), first),
+                                   vceqq_u8(vorrq_u8(tail, last_case), last));
+        // No movemask on NEON: narrow each byte to a nibble, 4 bits per position
+        uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        while (bits != 0) {
+            size_t position = static_cast<size_t>(__builtin_ctzll(bits)) / 4;
+            if (middleMatches(text, i + position, needle)) {
+                return true;
+            }
+            bits &= ~(0xFULL << (position * 4));
+        }
+        return false;
+    };
+
+    const size_t positions = length - needle.size + 1;
+    size_t i = 0;
+    for (; i + block <= positions; i += block) {
+        if (scanBlock(i)) {
+            return true;
+        }
+    }
+    return i < positions && scanBlock(positions - block);
+}
+
+#endif // TEXT_SCAN_NEON
+
+bool always() {
+    return true;
+}
+
+struct KernelInfo {
+    const char* name;
+    Kernel scan;
+    bool (*supported)();
+};
+
+// Fastest first
+const KernelInfo kernels[] = {
+#ifdef TEXT_SCAN_X86
+    {"avx2", scanAvx2, hasAvx2},
+    {"sse2", scanSse2, always},
+#endif
+#ifdef TEXT_SCAN_NEON
+    {"neon", scanNeon, always},
+#endif
+    {"scalar", scanScalar, always},
+};
+
+const KernelInfo* pickKernel() {
+    for (const KernelInfo& kernel : kernels) {
+        if (kernel.supported()) {
+            return &kernel;
+        }
+    }
+    return &kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+}
+
+std::atomic<const KernelInfo*>& activeKernel() {
+    static std::atomic<const KernelInfo*> active{pickKernel()};
+    return active;
+}
+
+} // namespace
+
+TextScan::TextScan(std::string_view needle) : folded(needle) {
+    for (char& c : folded) {
+        c = static_cast<char>(foldChar(static_cast<unsigned char>(c)));
+    }
+    if (!folded.empty()) {
+        first_case = isLetter(static_cast<unsigned char>(folded.front())) ? 0x20 : 0;
+        last_case = isLetter(static_cast<unsigned char>(folded.back())) ? 0x20 : 0;
+    }
+}
+
+bool TextScan::matches(std::string_view text) const {
+    if (folded.empty()) {
+        return true;
+    }
+    if (text.size() < folded.size()) {
+        return false;
+    }
+    Needle needle{folded.data(), folded.size(), first_case, last_case};
+    return activeKernel().load(std::memory_order_relaxed)->scan(text.data(), text.size(), needle);
+}
+
+const char* TextScan::kernelName() {
+    return activeKernel().load()->name;
+}
+
+bool TextScan::useKernel(std::string_view name) {
+    for (const KernelInfo& kernel : kernels) {
+        if (name == kernel.name) {
+            if (!kernel.supported()) {
+                return false;
+            }
+            activeKernel() = &kernel;
+            return true;
+        }
+    }
+    return false;
+}
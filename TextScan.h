@@ -0,0 +1,55 @@
+/**
+ * @file    TextScan.h
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Case-insensitive substring matching with SIMD kernels
+ *
+ * @details Declares TextScan, the substring test behind every search that
+ *          the full-text index does not answer: the snapshot scan, the
+ *          keyword scan of searchBooks, and the contains_text() SQL
+ *          function that replaces LIKE '%keyword%'. Matching ignores ASCII
+ *          case, like LIKE.
+ *
+ *          The kernels compare the first and the last byte of the needle at
+ *          16 or 32 positions at once, and only compare the rest where both
+ *          match. The kernel is picked once per process from what the CPU
+ *          supports: AVX2, else SSE2 (every x86-64 CPU), NEON on ARM64, and
+ *          a scalar loop everywhere else.
+ *
+ */
+
+#ifndef TEXT_SCAN_H
+#define TEXT_SCAN_H
+
+#include <string>
+#include <string_view>
+
+class TextScan {
+public:
+    // Empty needle, which every text contains
+    TextScan() = default;
+
+    explicit TextScan(std::string_view needle);
+
+    // True if text contains the needle, ignoring ASCII case
+    bool matches(std::string_view text) const;
+
+    // The needle, folded to lowercase
+    const std::string& needle() const { return folded; }
+
+    // Kernel in use: "avx2", "sse2", "neon" or "scalar"
+    static const char* kernelName();
+
+    // Switch every TextScan to the named kernel, for benchmarks and comparisons;
+    // false if the name is unknown or this CPU cannot run it
+    static bool useKernel(std::string_view name);
+
+private:
+    std::string folded;
+    unsigned char first_case = 0;  // 0x20 if the first byte is a letter: OR-ing it in folds the text
+    unsigned char last_case = 0;   // The same for the last byte
+};
+
+#endif // TEXT_SCAN_H
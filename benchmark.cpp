@@ -0,0 +1,358 @@
+/**
+ * @file    benchmark.cpp
+ * @author  Ashisha Sutradhar
+ * @date    2025-03-17
+ * @version 1.0.0
+ *
+ * @brief   Benchmark suite for the BookArchive library
+ *
+ * @details Builds generated datasets of configurable sizes and measures the
+ *          main BookArchive operations against them: single and bulk
+ *          inserts, id lookups, short and long keyword searches, paged
+ *          display, concurrent updates and a mixed read/write workload at
+ *          1..N threads. Every
+ *          workload reports ops/sec and p50/p99/p999 latency, as a table on
+ *          stdout and optionally as JSON for tracking over time.
+ *
+ * @usage   book_archive_bench [--rows 10000,1000000] [--threads N] [--ops N]
+ *                             [--readers N] [--db file] [--json file|-]
+ */
+
+#include "BookArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Discards everything the archive prints while a workload runs
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct Options {
+    std::vector<size_t> rows = {10000};
+    size_t max_threads = std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    size_t ops = 2000;
+    size_t readers = DEFAULT_READ_CONNECTIONS;
+    std::string db_file = "bench_archive.db";
+    std::string json_file;
+};
+
+struct Result {
+    size_t dataset_rows;
+    std::string workload;
+    size_t threads;
+    size_t ops;
+    double seconds;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+};
+
+const char* const kWords[] = {
+    "river", "shadow", "garden", "empire", "winter", "silver", "ocean", "forest", "night", "stone",
+    "dragon", "crown", "storm", "memory", "island", "mirror", "secret", "journey", "flame", "harbor",
+    "castle", "desert", "valley", "whisper", "thunder", "lantern", "midnight", "orchard", "glass", "spring",
+    "hollow", "kingdom", "sparrow", "meadow", "tide", "ember", "raven", "summer", "wolf", "autumn"
+};
+const char* const kFirstNames[] = {
+    "Ada", "Boris", "Clara", "Dmitri", "Elena", "Farah", "Gustav", "Hana", "Ivan", "Jun",
+    "Kofi", "Lena", "Marco", "Nadia", "Omar", "Priya", "Quentin", "Rosa", "Sven", "Tara"
+};
+const char* const kLastNames[] = {
+    "Abara", "Brandt", "Castillo", "Dumont", "Eriksen", "Fujita", "Galloway", "Haddad", "Ibsen", "Jansen",
+    "Kowalski", "Lindqvist", "Moreau", "Nakamura", "Okafor", "Petrov", "Quinn", "Rahman", "Sato", "Tanaka"
+};
+
+template <typename T, size_t N>
+constexpr size_t countOf(const T (&)[N]) { return N; }
+
+// Deterministic title/author for a given id, so every run sees the same data
+Book makeBook(int id) {
+    std::mt19937 rng(static_cast<uint32_t>(id) * 2654435761u);
+    size_t words = 2 + rng() % 4;
+    std::string title;
+    for (size_t i = 0; i < words; ++i) {
+        if (i > 0) {
+            title += ' ';
+        }
+        title += kWords[rng() % countOf(kWords)];
+    }
+    std::string author = std::string(kFirstNames[rng() % countOf(kFirstNames)]) + " " +
+                         kLastNames[rng() % countOf(kLastNames)];
+    return Book{id, title, author};
+}
+
+double percentile(std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Run op(thread, i) ops_per_thread times on each of threads threads
+template <typename Op>
+Result runWorkload(const std::string& name, size_t dataset_rows, size_t threads,
+                   size_t ops_per_thread, Op op) {
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<double>& samples = latencies[t];
+            samples.reserve(ops_per_thread);
+            for (size_t i = 0; i < ops_per_thread; ++i) {
+                auto begin = std::chrono::steady_clock::now();
+                op(t, i);
+                samples.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    for (auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    return Result{dataset_rows, name, threads, all.size(), seconds,
+                  percentile(all, 0.50), percentile(all, 0.99), percentile(all, 0.999)};
+}
+
+void printResult(const Result& r) {
+    std::printf("%10zu  %-16s %7zu %9zu %14.0f %11.1f %11.1f %11.1f\n",
+                r.dataset_rows, r.workload.c_str(), r.threads, r.ops,
+                r.seconds > 0 ? r.ops / r.seconds : 0.0, r.p50_us, r.p99_us, r.p999_us);
+    std::fflush(stdout);
+}
+
+void removeDatabase(const std::string& db_file) {
+    std::remove(db_file.c_str());
+    std::remove((db_file + "-wal").c_str());
+    std::remove((db_file + "-shm").c_str());
+}
+
+std::vector<size_t> threadCounts(size_t max_threads) {
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+void benchmarkDataset(const Options& opt, size_t rows, std::vector<Result>& results) {
+    auto record = [&](Result r) {
+        printResult(r);
+        results.push_back(std::move(r));
+    };
+
+    removeDatabase(opt.db_file);
+    BookArchive archive(opt.db_file, LogLevel::ERROR, opt.readers);
+
+    // Bulk load in chunks so even 10M rows never sit in memory at once
+    const size_t chunk = 100000;
+    size_t loaded = 0;
+    // Latencies are per chunk; throughput is reported in rows
+    Result bulk = runWorkload("add_bulk", rows, 1, (rows + chunk - 1) / chunk, [&](size_t, size_t) {
+        size_t count = std::min(chunk, rows - loaded);
+        std::vector<Book> books;
+        books.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            books.push_back(makeBook(static_cast<int>(loaded + i + 1)));
+        }
+        archive.addBooks(books);
+        loaded += count;
+    });
+    bulk.ops = rows;
+    record(bulk);
+
+    std::atomic<int> next_id(static_cast<int>(rows) + 1);
+    record(runWorkload("add_single", rows, 1, opt.ops, [&](size_t, size_t) {
+        int id = next_id++;
+        Book book = makeBook(id);
+        archive.addBook(id, book.title, book.author);
+    }));
+
+    for (size_t threads : threadCounts(opt.max_threads)) {
+        std::vector<std::mt19937> rngs;
+        for (size_t t = 0; t < threads; ++t) {
+            rngs.emplace_back(static_cast<uint32_t>(t + 1));
+        }
+        std::uniform_int_distribution<int> any_id(1, static_cast<int>(rows));
+
+        record(runWorkload("get_by_id", rows, threads, opt.ops, [&](size_t t, size_t) {
+            archive.getBook(any_id(rngs[t]));
+        }));
+
+        record(runWorkload("search_short", rows, threads, std::max<size_t>(1, opt.ops / 20), [&](size_t t, size_t) {
+            // Three-letter prefix of a common word: many matches, paged like an interactive user
+            std::string prefix = std::string(kWords[rngs[t]() % countOf(kWords)]).substr(0, 3);
+            PageOptions page;
+            page.limit = DISPLAY_PAGE_SIZE;
+            archive.searchBook(prefix, page);
+        }));
+
+        record(runWorkload("search_long", rows, threads, std::max<size_t>(1, opt.ops / 10), [&](size_t t, size_t) {
+            // The exact title and author of an existing book: few matches
+            Book book = makeBook(any_id(rngs[t]));
+            archive.searchBook(book.title + " " + book.author.str());
+        }));
+
+        record(runWorkload("display_page", rows, threads, std::max<size_t>(1, opt.ops / 10), [&](size_t t, size_t) {
+            PageOptions page;
+            page.after_id = any_id(rngs[t]);
+            page.limit = DISPLAY_PAGE_SIZE;
+            archive.listBooks(page);
+        }));
+
+        record(runWorkload("update_only", rows, threads, std::max<size_t>(1, opt.ops / 4), [&](size_t t, size_t) {
+            int id = any_id(rngs[t]);
+            Book book = makeBook(id);
+            archive.updateBook(id, book.title, book.author);
+        }));
+
+        record(runWorkload("mixed_90r_10w", rows, threads, opt.ops, [&](size_t t, size_t) {
+            int id = any_id(rngs[t]);
+            unsigned roll = rngs[t]() % 100;
+            if (roll < 90) {
+                archive.getBook(id);
+            } else {
+                Book book = makeBook(id);
+                archive.updateBook(id, book.title, book.author);
+            }
+        }));
+    }
+}
+
+void writeJson(const std::string& path, const Options& opt, const std::vector<Result>& results) {
+    std::ostringstream json;
+    json << "{\n  \"version\": \"" << VERSION << "\",\n"
+         << "  \"sqlite_version\": \"" << sqlite3_libversion() << "\",\n"
+         << "  \"readers\": " << opt.readers << ",\n"
+         << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        json << "    {\"dataset_rows\": " << r.dataset_rows
+             << ", \"workload\": \"" << r.workload << "\""
+             << ", \"threads\": " << r.threads
+             << ", \"ops\": " << r.ops
+             << ", \"seconds\": " << r.seconds
+             << ", \"ops_per_sec\": " << (r.seconds > 0 ? r.ops / r.seconds : 0.0)
+             << ", \"p50_us\": " << r.p50_us
+             << ", \"p99_us\": " << r.p99_us
+             << ", \"p999_us\": " << r.p999_us << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+
+    if (path == "-") {
+        std::fputs(json.str().c_str(), stdout);
+    } else {
+        std::ofstream out(path, std::ios::trunc);
+        out << json.str();
+        std::printf("Results written to %s\n", path.c_str());
+    }
+}
+
+bool parseSizes(const std::string& list, std::vector<size_t>& sizes) {
+    sizes.clear();
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        try {
+            sizes.push_back(std::stoul(item));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !sizes.empty();
+}
+
+void printUsage(const char* programName) {
+    std::printf("Usage: %s [options]\n", programName);
+    std::printf("Options:\n");
+    std::printf("  --rows <n,n,...>   Dataset sizes to generate (default: 10000, e.g. 10000,1000000,10000000)\n");
+    std::printf("  --threads <n>      Highest thread count for concurrent workloads (default: min(8, cores))\n");
+    std::printf("  --ops <n>          Operations per thread for point workloads (default: 2000)\n");
+    std::printf("  --readers <n>      Read-only connections in the archive (default: %d)\n", DEFAULT_READ_CONNECTIONS);
+    std::printf("  --db <file>        Scratch database file (default: bench_archive.db, deleted between datasets)\n");
+    std::printf("  --json <file|->    Also write results as JSON to a file or stdout\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--rows" && hasValue) {
+                if (!parseSizes(argv[++i], opt.rows)) {
+                    std::fprintf(stderr, "Error: Invalid dataset sizes '%s'\n", argv[i]);
+                    return 1;
+                }
+            } else if (arg == "--threads" && hasValue) {
+                opt.max_threads = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else if (arg == "--ops" && hasValue) {
+                opt.ops = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else if (arg == "--readers" && hasValue) {
+                opt.readers = std::stoul(argv[++i]);
+            } else if (arg == "--db" && hasValue) {
+                opt.db_file = argv[++i];
+            } else if (arg == "--json" && hasValue) {
+                opt.json_file = argv[++i];
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else {
+                std::fprintf(stderr, "Unknown or incomplete option: %s\n", arg.c_str());
+                printUsage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::fprintf(stderr, "Error: Invalid value for %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    // The archive reports every operation on std::cout; keep that out of the numbers
+    NullBuffer null_buffer;
+    std::streambuf* console = std::cout.rdbuf(&null_buffer);
+
+    std::printf("Book Archive %s benchmark, SQLite %s, %zu reader(s)\n\n", VERSION, sqlite3_libversion(), opt.readers);
+    std::printf("%10s  %-16s %7s %9s %14s %11s %11s %11s\n",
+                "rows", "workload", "threads", "ops", "ops/sec", "p50 us", "p99 us", "p999 us");
+
+    std::vector<Result> results;
+    int status = 0;
+    try {
+        for (size_t rows : opt.rows) {
+            benchmarkDataset(opt, rows, results);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        status = 1;
+    }
+    removeDatabase(opt.db_file);
+
+    std::cout.rdbuf(console);
+
+    if (!opt.json_file.empty()) {
+        writeJson(opt.json_file, opt, results);
+    }
+    return status;
+}
@@ -14,17 +14,26 @@
  */
 
 #include "BookArchive.h"
+#include "ArchiveServer.h"
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <csignal>
 #include <cstring>
+#include <fstream>
+#include <algorithm>
 
 // Global pointer for signal handling
 BookArchive* g_archive = nullptr;
+ArchiveServer* g_server = nullptr;
 
 // Signal handler for clean shutdown
 void signalHandler(int signal) {
+    if ((signal == SIGINT || signal == SIGTERM) && g_server) {
+        // Let the event loop return so main can shut down in order
+        g_server->stop();
+        return;
+    }
     if (signal == SIGINT || signal == SIGTERM) {
         std::cout << "\nReceived termination signal. Shutting down gracefully..." << std::endl;
         if (g_archive) {
@@ -40,6 +49,22 @@ void printUsage(const char* programName) {
     std::cout << "Options:" << std::endl;
     std::cout << "  --db, -d <filename>     Specify database file (default: book_archive.db)" << std::endl;
     std::cout << "  --log-level, -l <level> Set log level (DEBUG, INFO, ERROR) (default: ERROR in release, DEBUG in debug)" << std::endl;
+    std::cout << "  --snapshot <file>       Serve a snapshot file read-only instead of a database" << std::endl;
+    std::cout << "  --profile, -p <name>    Database tuning profile: " << DatabaseConfig::profileNames() 
+              << " (default: " << DEFAULT_DATABASE_PROFILE << ")" << std::endl;
+    std::cout << "  --config, -c <file>     Read database settings (key = value lines) on top of the profile" << std::endl;
+    std::cout << "  --bulk-imports          Use the bulk-load settings while import/load-snapshot run" << std::endl;
+    std::cout << "  --read-only             Open an existing database without writing to it or its schema" << std::endl;
+    std::cout << "  --format, -f <format>   How listing commands print books: table, tsv or json (default: table)" << std::endl;
+    std::cout << "  --readers, -r <count>   Number of read-only database connections (default: " << DEFAULT_READ_CONNECTIONS << ")" << std::endl;
+    std::cout << "  --batch, -b             Read commands from stdin without prompts, buffering output" << std::endl;
+    std::cout << "  --script, -s <file>     Run the commands in a file (implies --batch)" << std::endl;
+    std::cout << "  --group, -g <count>     In batch mode, commit up to <count> consecutive add/update/delete" << std::endl;
+    std::cout << "                          commands in one transaction (default: 1)" << std::endl;
+    std::cout << "  --serve <[host:]port>   Serve commands over TCP (default host: " << SERVER_DEFAULT_HOST << ")" << std::endl;
+    std::cout << "  --workers, -w <count>   Worker threads running server requests (default: CPU count)" << std::endl;
+    std::cout << "  --serve-admin           Also serve import, export, export-snapshot, load-snapshot, debug" << std::endl;
+    std::cout << "                          delete-many --file and search-many --file" << std::endl;
     std::cout << "  --help, -h              Display this help message" << std::endl;
     std::cout << "  --version, -v           Display version information" << std::endl;
 }
@@ -60,6 +85,20 @@ LogLevel parseLogLevel(const std::string& level) {
 
 int main(int argc, char** argv) {
     std::string db_file = "book_archive.db";
+    std::string snapshot_file;
+    std::string profile_name;
+    std::string config_file;
+    bool bulk_imports = false;
+    bool read_only = false;
+    OutputFormat output_format = OutputFormat::TABLE;
+    size_t read_connections = DEFAULT_READ_CONNECTIONS;
+    bool batch_mode = false;
+    std::string script_file;
+    size_t group_size = 1;
+    std::string serve_host = SERVER_DEFAULT_HOST;
+    int serve_port = -1;
+    bool serve_admin = false;
+    size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
     LogLevel log_level = 
         #ifdef DEBUG_MODE
             LogLevel::DEBUG;
@@ -78,6 +117,41 @@ int main(int argc, char** argv) {
                     std::cerr << "Error: Missing database filename after " << arg << std::endl;
                     return 1;
                 }
+            } else if (arg == "--snapshot") {
+                if (i + 1 < argc) {
+                    snapshot_file = argv[++i];
+                } else {
+                    std::cerr << "Error: Missing snapshot filename after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--profile" || arg == "-p") {
+                if (i + 1 < argc) {
+                    profile_name = argv[++i];
+                } else {
+                    std::cerr << "Error: Missing profile name after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--config" || arg == "-c") {
+                if (i + 1 < argc) {
+                    config_file = argv[++i];
+                } else {
+                    std::cerr << "Error: Missing config filename after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--bulk-imports") {
+                bulk_imports = true;
+            } else if (arg == "--read-only") {
+                read_only = true;
+            } else if (arg == "--format" || arg == "-f") {
+                if (i + 1 < argc) {
+                    if (!OutputSink::parseFormat(argv[++i], output_format)) {
+                        std::cerr << "Error: Invalid output format '" << argv[i] << "' (expected table, tsv or json)" << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: Missing output format after " << arg << std::endl;
+                    return 1;
+                }
             } else if (arg == "--log-level" || arg == "-l") {
                 if (i + 1 < argc) {
                     log_level = parseLogLevel(argv[++i]);
@@ -85,6 +159,75 @@ int main(int argc, char** argv) {
                     std::cerr << "Error: Missing log level after " << arg << std::endl;
                     return 1;
                 }
+            } else if (arg == "--readers" || arg == "-r") {
+                if (i + 1 < argc) {
+                    try {
+                        read_connections = std::stoul(argv[++i]);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid reader count '" << argv[i] << "'" << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: Missing reader count after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--batch" || arg == "-b") {
+                batch_mode = true;
+            } else if (arg == "--script" || arg == "-s") {
+                if (i + 1 < argc) {
+                    script_file = argv[++i];
+                    batch_mode = true;
+                } else {
+                    std::cerr << "Error: Missing script filename after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--group" || arg == "-g") {
+                if (i + 1 < argc) {
+                    try {
+                        group_size = std::stoul(argv[++i]);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid group size '" << argv[i] << "'" << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: Missing group size after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--serve") {
+                if (i + 1 < argc) {
+                    std::string address = argv[++i];
+                    size_t colon = address.rfind(':');
+                    if (colon != std::string::npos) {
+                        serve_host = address.substr(0, colon);
+                        address = address.substr(colon + 1);
+                    }
+                    try {
+                        serve_port = std::stoi(address);
+                    } catch (const std::exception& e) {
+                        serve_port = -1;
+                    }
+                    if (serve_port < 0 || serve_port > 65535) {
+                        std::cerr << "Error: Invalid port '" << argv[i] << "'" << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: Missing port after " << arg << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--serve-admin") {
+                serve_admin = true;
+            } else if (arg == "--workers" || arg == "-w") {
+                if (i + 1 < argc) {
+                    try {
+                        worker_count = std::stoul(argv[++i]);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid worker count '" << argv[i] << "'" << std::endl;
+                        return 1;
+                    }
+                } else {
+                    std::cerr << "Error: Missing worker count after " << arg << std::endl;
+                    return 1;
+                }
             } else if (arg == "--help" || arg == "-h") {
                 printUsage(argv[0]);
                 return 0;
@@ -106,14 +249,70 @@ int main(int argc, char** argv) {
         }
     }
     
+    // The profile is the base, the config file overrides it, then individual flags
+    DatabaseConfig config;
+    if (!profile_name.empty() && !config.applyProfile(profile_name)) {
+        std::cerr << "Error: Unknown profile '" << profile_name << "'. Available: " 
+                  << DatabaseConfig::profileNames() << std::endl;
+        return 1;
+    }
+    if (!config_file.empty()) {
+        std::string error;
+        if (!config.loadFile(config_file, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+    if (bulk_imports) {
+        config.bulk_imports = true;
+        config.customized = true;
+    }
+    if (read_only) {
+        config.read_only = true;
+    }
+    
+    std::ifstream script;
+    if (!script_file.empty()) {
+        script.open(script_file);
+        if (!script) {
+            std::cerr << "Error: Cannot open script file '" << script_file << "'" << std::endl;
+            return 1;
+        }
+    }
+    
     // Set up signal handlers for clean shutdown
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
     
     try {
         // Create the BookArchive object on the heap so we can use it in signal handler
-        g_archive = new BookArchive(db_file, log_level);
-        g_archive->run();
+        if (snapshot_file.empty()) {
+            g_archive = new BookArchive(db_file, log_level, read_connections, config);
+        } else {
+            g_archive = new BookArchive(SnapshotFile{snapshot_file}, log_level);
+        }
+        g_archive->setOutputFormat(output_format);
+        if (serve_port >= 0) {
+            ArchiveServer server(*g_archive, worker_count, serve_admin);
+            std::string error;
+            if (!server.start(serve_host, static_cast<uint16_t>(serve_port), error)) {
+                std::cerr << "Error: " << error << std::endl;
+                delete g_archive;
+                g_archive = nullptr;
+                return 1;
+            }
+            
+            std::cout << "Book Archive " << VERSION << " serving on " << serve_host << ":" << serve_port 
+                      << " with " << worker_count << " worker(s)" << std::endl;
+            g_server = &server;
+            server.run();
+            g_server = nullptr;
+            std::cout << "Server stopped." << std::endl;
+        } else if (batch_mode) {
+            g_archive->runBatch(script_file.empty() ? std::cin : script, group_size);
+        } else {
+            g_archive->run();
+        }
         
         // Clean shutdown
         delete g_archive;